@@ -0,0 +1,171 @@
+/**
+ * @file bench_e2e.cpp
+ * @brief End-to-end throughput and recall of the secret_scanner binary on a generated repository.
+ *
+ * Generates a corpus with generate_corpus, turns it into a git work tree so .gitignore
+ * applies, and runs the real CLI over it with --write-baseline. The baseline holds the
+ * fingerprint of every reported finding, so recall is checked by fingerprinting each
+ * planted secret the same way the scanner does. Wall time and peak RSS are those of the
+ * scanner process alone; generating the corpus is not timed.
+ *
+ * Usage: bench_e2e [--files=N] [--seed=N] [--size-scale=X] [--dir=DIR] [--scanner=PATH]
+ *                  [--no-git] [-- scanner flags...]
+ *
+ * A missed planted secret makes the benchmark exit with status 1, so it also works as a
+ * recall regression check.
+ *
+ * @author Dorna Raj Gyawali <dronarajgyawali@gmail.com>
+ * @date 2025
+ */
+
+#include <chrono>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "baseline.h"
+#include "corpus.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+struct RunResult {
+    int status = -1;
+    double seconds = 0;
+    long peak_rss_kib = 0;
+};
+
+// runs the command in dir with its output discarded; wait4 reports the child's own peak RSS
+RunResult run_in(const std::string& dir, const std::vector<std::string>& args) {
+    std::vector<char*> argv;
+    for (const auto& arg : args) argv.push_back(const_cast<char*>(arg.c_str()));
+    argv.push_back(nullptr);
+
+    RunResult result;
+    auto start = std::chrono::steady_clock::now();
+    pid_t pid = fork();
+    if (pid == 0) {
+        int null_fd = open("/dev/null", O_WRONLY);
+        dup2(null_fd, STDOUT_FILENO);
+        dup2(null_fd, STDERR_FILENO);
+        if (chdir(dir.c_str()) != 0) _exit(127);
+        execvp(argv[0], argv.data());
+        _exit(127);
+    }
+    if (pid < 0) return result;
+    int status = 0;
+    struct rusage usage {};
+    wait4(pid, &status, 0, &usage);
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    result.status = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+    result.peak_rss_kib = usage.ru_maxrss;
+    return result;
+}
+
+bool take(const std::string& arg, const std::string& name, std::string& value) {
+    if (arg.rfind(name + "=", 0) != 0) return false;
+    value = arg.substr(name.size() + 1);
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    CorpusConfig config;
+    std::string dir, scanner = SECRET_SCANNER_BINARY;
+    bool use_git = true;
+    std::vector<std::string> scanner_flags;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        std::string value;
+        if (arg == "--") {
+            scanner_flags.assign(argv + i + 1, argv + argc);
+            break;
+        } else if (take(arg, "--files", value)) {
+            config.files = std::stoul(value);
+        } else if (take(arg, "--seed", value)) {
+            config.seed = static_cast<uint32_t>(std::stoul(value));
+        } else if (take(arg, "--size-scale", value)) {
+            config.size_scale = std::stod(value);
+        } else if (take(arg, "--dir", value)) {
+            dir = value;
+        } else if (take(arg, "--scanner", value)) {
+            scanner = value;
+        } else if (arg == "--no-git") {
+            use_git = false;
+        } else {
+            std::cerr << "Unknown argument " << arg << "\n";
+            return 2;
+        }
+    }
+    const bool keep = !dir.empty();
+    if (!keep) dir = (fs::temp_directory_path() / ("secret_scanner_corpus_" + std::to_string(getpid()))).string();
+    dir = fs::absolute(dir).lexically_normal().string();
+
+    Corpus corpus;
+    std::string error;
+    auto start = std::chrono::steady_clock::now();
+    if (!generate_corpus(dir, config, corpus, error)) {
+        std::cerr << error << "\n";
+        return 2;
+    }
+    auto generated = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (use_git && run_in(dir, {"git", "init", "-q"}).status != 0) {
+        std::cerr << "git init failed; .gitignore will not apply (use --no-git to silence)\n";
+        use_git = false;
+    }
+
+    const size_t scanned_files = corpus.count(CorpusPlacement::scanned);
+    const double scanned_mib = corpus.bytes(CorpusPlacement::scanned) / (1024.0 * 1024.0);
+    std::cout << std::fixed << std::setprecision(1) << "Corpus " << dir << " (seed " << config.seed << "): "
+              << corpus.files.size() << " files, " << scanned_files << " to scan (" << scanned_mib << " MiB), "
+              << corpus.count(CorpusPlacement::ignored_dir) << " in ignored dirs, "
+              << corpus.count(CorpusPlacement::gitignored) << " gitignored, " << corpus.count(CorpusPlacement::binary)
+              << " binary; generated in " << generated << " s\n";
+
+    const std::string baseline_path = dir + ".baseline";
+    std::vector<std::string> command = {scanner, "--write-baseline=" + baseline_path};
+    command.insert(command.end(), scanner_flags.begin(), scanner_flags.end());
+    command.push_back(dir);
+    RunResult run = run_in(dir, command);
+
+    Baseline found;
+    if (run.status < 0 || run.status > 1 || !found.load(baseline_path, error)) {
+        std::cerr << "Scanner run failed (status " << run.status << ")" << (error.empty() ? "" : ": " + error) << "\n";
+        return 2;
+    }
+
+    size_t planted = 0, hits = 0, decoys = 0, decoy_hits = 0;
+    std::map<std::string, size_t> missed;
+    for (const auto& secret : corpus.secrets) {
+        const bool hit = found.contains(finding_fingerprint(secret.rule, secret.text, secret.rel_path));
+        // without git the gitignored files are scanned like any other
+        if (secret.placement == CorpusPlacement::scanned || (!use_git && secret.placement == CorpusPlacement::gitignored)) {
+            ++planted;
+            if (hit) ++hits;
+            else ++missed[secret.rule];
+        } else {
+            ++decoys;
+            if (hit) ++decoy_hits;
+        }
+    }
+
+    std::cout << std::setprecision(2) << "Scan: " << run.seconds << " s, " << scanned_files / run.seconds
+              << " files/s, " << scanned_mib / run.seconds << " MiB/s, peak RSS " << run.peak_rss_kib / 1024.0
+              << " MiB\n";
+    std::cout << "Recall: " << hits << "/" << planted << " planted secrets ("
+              << (planted ? 100.0 * hits / planted : 100.0) << "%), " << decoy_hits << "/" << decoys
+              << " decoys in ignored files reported, " << found.size() - hits - decoy_hits << " other findings\n";
+    for (const auto& [rule, count] : missed) std::cout << "  missed " << count << " x " << rule << "\n";
+
+    fs::remove(baseline_path);
+    if (!keep) fs::remove_all(dir);
+    return hits == planted && decoy_hits == 0 ? 0 : 1;
+}
@@ -0,0 +1,114 @@
+/**
+ * @file bench_pathfilter.cpp
+ * @brief Microbenchmark of path filtering: per-name substring loop vs compiled PathFilter.
+ *
+ * Generates a fixed set of repository-shaped paths and times, for each strategy, how long
+ * it takes to classify all of them. The legacy strategy is the original is_ignored_dir loop,
+ * which searches the whole path once per ignored name; the compiled strategy evaluates the
+ * same ignored names plus extra exclude globs in a single pass per path.
+ *
+ * @author Dorna Raj Gyawali <dronarajgyawali@gmail.com>
+ * @date 2025
+ */
+
+#include <chrono>
+#include <filesystem>
+#include <fnmatch.h>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "constants.h"
+#include "pathfilter.h"
+#include "scanner.h"
+#include "regexpattern.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+bool legacy_is_ignored_dir(const std::string& path_str) {
+    for (const auto& d : ignored_dirs) {
+        if (path_str.find("/" + d + "/") != std::string::npos ||
+            (path_str.size() >= d.size() + 1 &&
+             path_str.compare(path_str.size() - d.size() - 1, d.size() + 1, "/" + d) == 0)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::vector<std::string> make_paths(size_t count) {
+    const std::vector<std::string> dirs = {"src", "lib", "app", "components", "utils", "api",
+                                           "node_modules", "test", "fixtures", "internal", "pkg"};
+    const std::vector<std::string> files = {"index.js", "main.py", "config.yml", "README.md",
+                                            "app.min.js", "server.go", "schema.json"};
+    std::mt19937 rng(42);
+    std::vector<std::string> paths;
+    paths.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        std::string path = "/repo";
+        size_t depth = 2 + rng() % 6;
+        for (size_t d = 0; d < depth; ++d) {
+            path += "/" + dirs[rng() % dirs.size()];
+        }
+        path += "/" + files[rng() % files.size()];
+        paths.push_back(std::move(path));
+    }
+    return paths;
+}
+
+template <class F>
+void run(const std::string& name, const std::vector<std::string>& paths, F&& classify) {
+    auto start = std::chrono::steady_clock::now();
+    size_t hits = 0;
+    for (const auto& p : paths) {
+        hits += classify(p) ? 1 : 0;
+    }
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << name << ": " << elapsed * 1e9 / paths.size() << " ns/path, "
+              << hits << " excluded\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t count = argc > 1 ? std::stoul(argv[1]) : 500000;
+    auto paths = make_paths(count);
+    const std::vector<std::string> extra_globs = {"**/fixtures/**", "*.min.js", "docs/*.md",
+                                                  "**/testdata/**", "*.snap", "/vendor"};
+
+    std::cout << "Classifying " << count << " paths\n";
+
+    run("legacy is_ignored_dir loop", paths, [](const std::string& p) {
+        return legacy_is_ignored_dir(fs::path(p).parent_path().generic_string());
+    });
+
+    SecretScanner scanner(ignored_dirs, valid_extensions, std::vector<std::pair<std::string, std::regex>>{});
+    run("SecretScanner::is_ignored_dir", paths, [&](const std::string& p) {
+        return scanner.is_ignored_dir(fs::path(p).parent_path());
+    });
+
+    PathFilter dirs_only = PathFilter::from_ignored_dirs(ignored_dirs);
+    run("PathFilter (ignored dirs)", paths, [&](const std::string& p) {
+        return dirs_only.match(std::string_view(p).substr(6), false).excluded;
+    });
+
+    run("fnmatch loop (ignored dirs + globs)", paths, [&](const std::string& p) {
+        if (legacy_is_ignored_dir(fs::path(p).parent_path().generic_string())) return true;
+        std::string rel = p.substr(6);
+        std::string base = fs::path(p).filename().string();
+        for (const auto& g : extra_globs) {
+            const std::string& subject = g.find('/') == std::string::npos ? base : rel;
+            if (fnmatch(g.c_str(), subject.c_str(), 0) == 0) return true;
+        }
+        return false;
+    });
+
+    PathFilter full = PathFilter::from_ignored_dirs(ignored_dirs);
+    for (const auto& g : extra_globs) full.add_exclude(g);
+    run("PathFilter (ignored dirs + globs)", paths, [&](const std::string& p) {
+        return full.match(std::string_view(p).substr(6), false).excluded;
+    });
+    return 0;
+}
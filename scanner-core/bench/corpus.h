@@ -0,0 +1,73 @@
+#ifndef CORPUS_H
+#define CORPUS_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief Shape of a generated repository.
+ */
+struct CorpusConfig {
+    uint32_t seed = 1;               ///< same seed and config give the same tree, byte for byte
+    size_t files = 2000;             ///< files written, including ignored and binary ones
+    double size_scale = 1.0;         ///< multiplies every file size
+    double ignored_share = 0.15;     ///< files under node_modules, dist and build
+    double gitignored_share = 0.05;  ///< files matched by the generated .gitignore
+    double minified_share = 0.02;    ///< bundles made of 64 KiB lines
+    double binary_share = 0.03;      ///< images and archives the scanner skips by extension
+    size_t secrets_per_rule = 4;     ///< secrets planted in scanned files for every rule
+    size_t decoys_per_rule = 1;      ///< secrets planted in ignored and gitignored files for every rule
+};
+
+/**
+ * @brief Where a file sits relative to the scanner's filters.
+ */
+enum class CorpusPlacement {
+    scanned,      ///< selected by the default filters; its secrets must be reported
+    ignored_dir,  ///< under a directory the walker prunes
+    gitignored,   ///< matched by .gitignore (only skipped when the tree is a git work tree)
+    binary,       ///< extension the scanner does not read
+};
+
+struct CorpusFile {
+    std::string rel_path;   ///< relative to the corpus root, with forward slashes
+    size_t bytes = 0;
+    CorpusPlacement placement = CorpusPlacement::scanned;
+};
+
+struct PlantedSecret {
+    std::string rule;       ///< name of the rule the secret was planted for
+    std::string rel_path;
+    std::string text;       ///< exactly the text the rule is expected to match
+    CorpusPlacement placement = CorpusPlacement::scanned;
+};
+
+struct Corpus {
+    std::vector<CorpusFile> files;
+    std::vector<PlantedSecret> secrets;
+
+    size_t count(CorpusPlacement placement) const;
+    uint64_t bytes(CorpusPlacement placement) const;
+};
+
+/**
+ * @brief Write a deterministic, repository-shaped tree of files with planted secrets
+ *
+ * The tree mixes source, config, docs, stylesheets and lockfiles with a skewed size
+ * distribution (mostly small files, a few multi-megabyte ones), minified bundles,
+ * node_modules-style ignored directories, a .gitignore and binary assets. Every rule of
+ * secret_rule_definitions gets secrets planted in scanned files, in places its scope
+ * allows, and decoys in ignored and gitignored files. Only std::mt19937 is used for
+ * randomness, so a seed produces the same tree with every standard library.
+ *
+ * @param root Directory to create; must not exist yet
+ * @param config Shape of the tree
+ * @param corpus Receives the files and secrets that were written
+ * @param error Receives a message on failure
+ * @return true if the whole tree was written
+ */
+bool generate_corpus(const std::string& root, const CorpusConfig& config, Corpus& corpus, std::string& error);
+
+#endif // CORPUS_H
@@ -0,0 +1,134 @@
+#ifndef AGGREGATE_H
+#define AGGREGATE_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <functional>
+#include <cstdint>
+#include <cstddef>
+#include "report.h"
+
+/**
+ * @brief Order in which a FindingAggregator hands its findings back.
+ */
+enum class FindingOrder {
+    location,   ///< finding_less: by file, offset, then rule; the per-finding report
+    secret,     ///< by rule, normalized secret, then location, so each group is contiguous
+};
+
+/**
+ * @brief The same secret matched by the same rule, with where it was found.
+ */
+struct FindingGroup {
+    std::string type;                      ///< rule name
+    std::string secret;                    ///< normalized matched text (see normalize_secret)
+    size_t count = 0;                      ///< every location, including those not kept
+    size_t files = 0;                      ///< distinct files among all locations
+    std::vector<FindingRecord> locations;  ///< the first locations in report order, up to the cap
+};
+
+/**
+ * @brief Canonical form of a matched secret used to group its locations
+ *
+ * Surrounding whitespace and quotes are dropped and CRLF line endings become LF, so a
+ * key pasted with different quoting or line endings is still one secret.
+ */
+std::string normalize_secret(std::string_view match);
+
+/**
+ * @brief Render a group as a single-line JSON object
+ * @return {"type":...,"secret":...,"count":...,"files":...,"locations":[{"file":...,"line":...,
+ *         "column":...,"offset":...},...]}
+ */
+std::string group_to_json(const FindingGroup& group);
+
+/**
+ * @brief Collects findings in bounded memory and returns them sorted.
+ *
+ * Findings are kept in memory until their estimated size passes the memory limit. They
+ * are then sorted and written to a run file in the spill directory, and memory starts
+ * over. Reading the findings back merges the runs and what is still in memory with a
+ * k-way heap merge, so output needs one finding per run in memory, however many findings
+ * there are. Runs hold the matched secrets, so they are created owner-only in a private
+ * directory made with mkdtemp; the directory and its runs are removed by clear() and by
+ * the destructor.
+ *
+ * In FindingOrder::secret the matched text is stored normalized. A run that cannot be
+ * written leaves the findings in memory and turns spilling off, so nothing is lost.
+ * Not thread safe; callers serialize access.
+ */
+class FindingAggregator {
+public:
+    static constexpr uint64_t default_memory_limit = 64 * 1024 * 1024;
+
+    /**
+     * @brief Constructor for FindingAggregator
+     * @param order_ Order of for_each
+     * @param memory_limit_ Estimated bytes of findings held before a run is spilled (0 = never spill)
+     * @param spill_dir_ Directory the private run directory is created in (empty = the system temporary directory)
+     */
+    explicit FindingAggregator(FindingOrder order_ = FindingOrder::location,
+                               uint64_t memory_limit_ = default_memory_limit, std::string spill_dir_ = "");
+    ~FindingAggregator();
+
+    FindingAggregator(const FindingAggregator&) = delete;
+    FindingAggregator& operator=(const FindingAggregator&) = delete;
+
+    /**
+     * @brief Add a finding, spilling a sorted run to disk when memory is full
+     */
+    void add(FindingRecord finding);
+
+    /**
+     * @brief Visit every finding in order
+     * @param visit Called once per finding
+     * @param error Receives a message if a run could not be read back
+     * @return false if a run could not be read; findings visited before that were complete
+     */
+    bool for_each(const std::function<void(const FindingRecord&)>& visit, std::string& error);
+
+    /**
+     * @brief Visit the findings grouped by rule and normalized secret (FindingOrder::secret only)
+     * @param max_locations Locations kept per group (0 = all)
+     * @param visit Called once per group, in rule and secret order
+     * @param error Receives a message if a run could not be read back
+     * @return false if a run could not be read
+     */
+    bool for_each_group(size_t max_locations, const std::function<void(const FindingGroup&)>& visit,
+                        std::string& error);
+
+    /**
+     * @brief Drop every finding and remove the run files
+     */
+    void clear();
+
+    size_t size() const { return total; }
+    size_t spilled_runs() const { return runs.size(); }
+    uint64_t memory_bytes() const { return held_bytes; }
+    FindingOrder order() const { return sort_order; }
+
+    /**
+     * @brief Why spilling was turned off, empty while it works
+     */
+    const std::string& spill_error() const { return spill_failure; }
+
+private:
+    struct RunReader;
+
+    FindingOrder sort_order;
+    uint64_t memory_limit;
+    std::string spill_dir;
+    std::string run_dir;          // private directory of this aggregator's runs, made on the first spill
+    std::vector<FindingRecord> held;
+    uint64_t held_bytes = 0;
+    size_t total = 0;
+    std::vector<std::string> runs;
+    std::string spill_failure;
+
+    bool less(const FindingRecord& a, const FindingRecord& b) const;
+    void sort_held();
+    void spill();
+};
+
+#endif // AGGREGATE_H
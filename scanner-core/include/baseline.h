@@ -0,0 +1,73 @@
+#ifndef BASELINE_H
+#define BASELINE_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief Compute the stable fingerprint of a finding
+ * @param rule_name Name of the rule that matched
+ * @param match_str Matched text; surrounding whitespace is trimmed and inner runs collapsed
+ * @param rel_path Path of the file relative to the scan root
+ * @return Non-zero 64-bit fingerprint
+ */
+uint64_t finding_fingerprint(std::string_view rule_name, std::string_view match_str, std::string_view rel_path);
+
+/**
+ * @brief Set of accepted finding fingerprints stored as a memory-mapped hash table.
+ *
+ * The file holds a small header followed by an open-addressing table of 64-bit fingerprints
+ * (zero marks an empty slot) with at most 50% load, so a lookup is a couple of probes into
+ * the mapped pages and nothing is parsed or copied when the baseline is loaded.
+ */
+class Baseline {
+public:
+    Baseline() = default;
+    ~Baseline();
+
+    Baseline(const Baseline&) = delete;
+    Baseline& operator=(const Baseline&) = delete;
+
+    /**
+     * @brief Map a baseline file into memory
+     * @param file_path Path to the baseline file
+     * @param error Receives a description of the problem on failure
+     * @return true if the file was mapped and its header is valid
+     */
+    bool load(const std::string& file_path, std::string& error);
+
+    /**
+     * @brief Check whether a fingerprint is part of the baseline
+     * @param fingerprint Value returned by finding_fingerprint
+     * @return true if the finding is known
+     */
+    bool contains(uint64_t fingerprint) const;
+
+    /**
+     * @brief Number of fingerprints in the baseline
+     */
+    size_t size() const { return count; }
+
+    /**
+     * @brief Write a baseline file containing the given fingerprints
+     * @param file_path Destination path; replaced atomically
+     * @param fingerprints Fingerprints to store (duplicates are ignored)
+     * @param error Receives a description of the problem on failure
+     * @return true on success
+     */
+    static bool write(const std::string& file_path, std::vector<uint64_t> fingerprints, std::string& error);
+
+private:
+    const uint64_t* slots = nullptr;
+    uint64_t capacity = 0;
+    uint64_t count = 0;
+    void* mapping = nullptr;
+    size_t mapping_size = 0;
+
+    void unmap();
+};
+
+#endif // BASELINE_H
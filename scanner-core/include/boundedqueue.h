@@ -0,0 +1,81 @@
+#ifndef BOUNDEDQUEUE_H
+#define BOUNDEDQUEUE_H
+
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <cstddef>
+
+/**
+ * @brief Fixed-capacity blocking queue used to connect pipeline stages.
+ *
+ * push() blocks while the queue is full, which propagates backpressure to the producer.
+ * pop() blocks while the queue is empty and returns false once the queue is closed and drained.
+ */
+template<class T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(size_t capacity_) : capacity(capacity_ ? capacity_ : 1) {}
+
+    /**
+     * @brief Add an item, waiting for free space
+     * @return false if the queue was closed and the item was dropped
+     */
+    bool push(T item) {
+        std::unique_lock<std::mutex> lock(mutex);
+        not_full.wait(lock, [this] { return closed || items.size() < capacity; });
+        if (closed)
+            return false;
+        items.push_back(std::move(item));
+        lock.unlock();
+        not_empty.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief Take the oldest item, waiting until one is available
+     * @return false once the queue is closed and empty
+     */
+    bool pop(T& item) {
+        std::unique_lock<std::mutex> lock(mutex);
+        not_empty.wait(lock, [this] { return closed || !items.empty(); });
+        if (items.empty())
+            return false;
+        item = std::move(items.front());
+        items.pop_front();
+        lock.unlock();
+        not_full.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief Stop accepting items; consumers drain what is left
+     */
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            closed = true;
+        }
+        not_empty.notify_all();
+        not_full.notify_all();
+    }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return items.size();
+    }
+
+    size_t max_size() const {
+        return capacity;
+    }
+
+private:
+    std::deque<T> items;
+    const size_t capacity;
+    bool closed = false;
+    mutable std::mutex mutex;
+    std::condition_variable not_empty;
+    std::condition_variable not_full;
+};
+
+#endif // BOUNDEDQUEUE_H
@@ -3,6 +3,7 @@
 
 #include <unordered_set>
 #include <string>
+#include <vector>
 
 /**
   @brief Contains constants for file extensions and ignored directories used in secret scanning.
@@ -10,4 +11,14 @@
 extern const std::unordered_set<std::string> valid_extensions;
 extern const std::unordered_set<std::string> ignored_dirs;
 
+/**
+  @brief Glob patterns for files that are scanned even though they have no known extension.
+*/
+extern const std::vector<std::string> default_include_globs;
+
+/**
+  @brief Name of the per-repository ignore file read from the scan root.
+*/
+extern const std::string ignore_file_name;
+
 #endif // CONSTANTS_H
@@ -0,0 +1,63 @@
+#ifndef CONTROLLER_H
+#define CONTROLLER_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Bounds for the adaptive worker counts.
+ */
+struct ConcurrencyLimits {
+    size_t min_readers = 1;
+    size_t max_readers = 16;
+    size_t min_matchers = 1;
+    size_t max_matchers = 4;
+};
+
+/**
+ * @brief What the pipeline observed during one control interval.
+ */
+struct StageSample {
+    double seconds = 0;          ///< length of the interval
+    uint64_t files_read = 0;     ///< files read during the interval
+    uint64_t bytes_read = 0;     ///< bytes read during the interval
+    double read_busy = 0;        ///< reader seconds spent inside read_file
+    double match_busy = 0;       ///< matcher seconds spent inside scan_buffer
+    size_t path_depth = 0;       ///< paths waiting to be read at the end of the interval
+    size_t buffer_depth = 0;     ///< buffers waiting to be matched at the end of the interval
+    size_t buffer_capacity = 1;
+};
+
+/**
+ * @brief Chooses reader and matcher counts from observed latency and utilization.
+ *
+ * Matchers are CPU bound: they are added while buffers pile up and every matcher is busy,
+ * and removed while they sit idle. Readers are I/O bound, and whether more of them help
+ * depends on the storage, so they are hill-climbed: when matchers are starved and paths
+ * are waiting, one reader is added, and it is taken back if read throughput did not improve.
+ * Readers are also shed while the buffer queue is full, since matching is then the limit.
+ */
+class ConcurrencyController {
+public:
+    ConcurrencyController(const ConcurrencyLimits& limits_, size_t readers_, size_t matchers_);
+
+    /**
+     * @brief Feed one interval and update the worker counts
+     * @param sample Observations for the interval that just ended
+     */
+    void update(const StageSample& sample);
+
+    size_t readers() const { return reader_count; }
+    size_t matchers() const { return matcher_count; }
+
+private:
+    ConcurrencyLimits limits;
+    size_t reader_count;
+    size_t matcher_count;
+
+    bool probing = false;         // a reader was added last interval and is being evaluated
+    double probe_baseline = 0;    // throughput before the probe
+    size_t cooldown = 0;          // intervals to wait before probing again
+};
+
+#endif // CONTROLLER_H
@@ -0,0 +1,67 @@
+#ifndef DECODER_H
+#define DECODER_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstddef>
+
+/**
+ * @brief A stretch of text that looks like base64 or hex encoded data.
+ */
+struct EncodedRun {
+    enum class Encoding {
+        base64,   ///< standard or URL-safe alphabet, optionally padded with '='
+        hex,      ///< an even number of hex digits
+    };
+
+    size_t offset = 0;    ///< position of the first character in the searched text
+    size_t length = 0;    ///< characters, including base64 padding
+    Encoding encoding = Encoding::base64;
+};
+
+/**
+ * @brief Find every base64 or hex run of at least min_length characters
+ *
+ * Runs are maximal stretches of base64 alphabet characters (both alphabets, so URL-safe
+ * tokens are found too) followed by at most two '=' padding characters. A run made only of
+ * hex digits with an even length is reported as hex. Bytes are classified 16 at a time with
+ * SSE2 where available and through a lookup table elsewhere.
+ *
+ * @param text Text to search
+ * @param min_length Shortest run to report, padding excluded
+ * @param runs Receives the runs in text order (cleared first)
+ */
+void find_encoded_runs(std::string_view text, size_t min_length, std::vector<EncodedRun>& runs);
+
+/**
+ * @brief Number of bytes a run decodes to
+ * @param run Run returned by find_encoded_runs
+ */
+size_t decoded_length(const EncodedRun& run);
+
+/**
+ * @brief Decode a run
+ * @param text Text the run was found in
+ * @param run Run returned by find_encoded_runs
+ * @param out Receives the decoded bytes (replaced)
+ */
+void decode_run(std::string_view text, const EncodedRun& run, std::string& out);
+
+/**
+ * @brief Position in the searched text of the character that encodes a decoded byte
+ * @param run Run the bytes were decoded from
+ * @param decoded_offset Offset into the decoded bytes
+ * @return Offset into the text the run was found in
+ */
+size_t encoded_offset(const EncodedRun& run, size_t decoded_offset);
+
+/**
+ * @brief Check whether decoded bytes are worth matching: nearly all printable ASCII
+ *
+ * Hashes, compressed data and long identifiers that happen to use the base64 alphabet
+ * decode to noise and are rejected here, before any rule runs over them.
+ */
+bool looks_like_text(std::string_view bytes);
+
+#endif // DECODER_H
@@ -0,0 +1,88 @@
+#ifndef ENGINE_H
+#define ENGINE_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+#include "ruleset.h"
+
+/**
+ * @brief A rule set compiled for one regular expression library.
+ *
+ * The scanner does the matching work that does not depend on the library: jumping between
+ * literal prefixes, bounding attempts on long lines, windowing streams and extending
+ * multi-line rules to their closing marker. It only asks the engine for the leftmost match
+ * of one rule's pattern inside a range, so every engine sees the same candidate positions
+ * and produces the same findings whenever the libraries agree on the pattern.
+ *
+ * A rule an engine cannot compile (a construct the library does not support, or a rule
+ * given only in compiled std::regex form) is matched with the rule set's std::regex, so
+ * switching engines never drops a rule. Engines are immutable after construction and may
+ * be shared by any number of scanners and threads.
+ */
+class MatchEngine {
+public:
+    enum class Part {
+        opening,   ///< the rule's pattern
+        closing,   ///< the closing pattern of a rule that spans lines
+    };
+
+    struct Match {
+        size_t offset = 0;   ///< position in the searched text
+        size_t length = 0;
+    };
+
+    virtual ~MatchEngine() = default;
+
+    /**
+     * @brief Name the engine is selected by
+     */
+    virtual const char* name() const = 0;
+
+    /**
+     * @brief Find the leftmost match of one pattern of a rule
+     * @param rule Index of the rule in the rule set the engine was built for
+     * @param part Which of the rule's patterns to search for
+     * @param text Text to search; bytes before from are only look-behind context
+     * @param from First position a match may start at
+     * @param to End of the searched range; matches never extend past it
+     * @param anchored Only accept a match that starts exactly at from
+     * @param match Receives the match when one is found
+     * @return true if a match was found
+     */
+    virtual bool search(uint32_t rule, Part part, std::string_view text, size_t from, size_t to, bool anchored,
+                        Match& match) const = 0;
+
+    /**
+     * @brief Number of rules this engine matches natively (the rest use std::regex)
+     */
+    virtual size_t native_rules() const = 0;
+
+    const RuleSet& get_rules() const { return *rules; }
+    const std::shared_ptr<const RuleSet>& shared_rules() const { return rules; }
+
+protected:
+    explicit MatchEngine(std::shared_ptr<const RuleSet> rules_) : rules(std::move(rules_)) {}
+
+    std::shared_ptr<const RuleSet> rules;
+};
+
+/**
+ * @brief Names of the engines compiled into this build, the default ("std") first
+ *
+ * "re2" is present when RE2 was found at configure time and "pcre2" when PCRE2 was.
+ */
+std::vector<std::string> available_engines();
+
+/**
+ * @brief Compile a rule set for the named engine
+ * @param name Engine name, one of available_engines()
+ * @param rules Rules to compile; the engine keeps them alive
+ * @return The engine, or nullptr if the name is unknown or not compiled into this build
+ */
+std::shared_ptr<const MatchEngine> make_engine(const std::string& name, std::shared_ptr<const RuleSet> rules);
+
+#endif // ENGINE_H
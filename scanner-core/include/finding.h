@@ -0,0 +1,89 @@
+#ifndef FINDING_H
+#define FINDING_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief One match, described by ids and offsets only.
+ *
+ * The rule name and file path are looked up from the ids when the finding is formatted,
+ * and the matched text lives in the FindingBuffer the finding was added to. A finding in
+ * decoded data is located at the encoded text it came from, while its matched text is the
+ * decoded secret, so length then counts decoded bytes.
+ */
+struct Finding {
+    uint32_t rule = 0;     ///< index into the scanner's RuleSet
+    uint32_t file = 0;     ///< caller-chosen id of the scanned file
+    uint32_t length = 0;   ///< match length in bytes
+    uint8_t decoded = 0;   ///< base64/hex layers decoded to reach the match (0 = plain text)
+    size_t offset = 0;     ///< byte offset of the match from the start of the file
+    size_t line = 0;       ///< 1-based line of the first byte of the match
+    size_t column = 0;     ///< 1-based column of the first byte of the match
+    size_t text = 0;       ///< where the matched bytes start in the buffer's arena
+};
+
+/**
+ * @brief Caller-owned result buffer that scans append to.
+ *
+ * Findings are kept in one vector and their matched bytes in one arena string. clear()
+ * keeps both allocations, so a buffer reused across scans stops allocating once it has
+ * grown to the largest result it has held.
+ */
+class FindingBuffer {
+public:
+    /**
+     * @brief Drop all findings but keep the allocated capacity
+     */
+    void clear() {
+        items.clear();
+        arena.clear();
+    }
+
+    /**
+     * @brief Pre-size the buffer
+     * @param findings Number of findings to make room for
+     * @param text_bytes Total bytes of matched text to make room for
+     */
+    void reserve(size_t findings, size_t text_bytes) {
+        items.reserve(findings);
+        arena.reserve(text_bytes);
+    }
+
+    /**
+     * @brief Add a finding and copy its matched text into the arena
+     * @param finding Finding to add; its text and length fields are set from match
+     * @param match Matched bytes
+     */
+    void append(Finding finding, std::string_view match) {
+        finding.text = arena.size();
+        finding.length = static_cast<uint32_t>(match.size());
+        arena.append(match.data(), match.size());
+        items.push_back(finding);
+    }
+
+    /**
+     * @brief Matched bytes of a finding held by this buffer
+     */
+    std::string_view text(const Finding& finding) const {
+        return std::string_view(arena).substr(finding.text, finding.length);
+    }
+
+    size_t size() const { return items.size(); }
+    bool empty() const { return items.empty(); }
+    const Finding& operator[](size_t index) const { return items[index]; }
+    std::vector<Finding>::const_iterator begin() const { return items.begin(); }
+    std::vector<Finding>::const_iterator end() const { return items.end(); }
+
+private:
+    friend class SecretScanner;
+    friend class IncrementalScan;
+
+    std::vector<Finding> items;
+    std::string arena;
+};
+
+#endif // FINDING_H
@@ -0,0 +1,75 @@
+#ifndef LINECOUNTER_H
+#define LINECOUNTER_H
+
+#include <string_view>
+#include <cstddef>
+
+/**
+ * @brief Count '\n' bytes in a range using SIMD where available (SSE2 / NEON)
+ * @param data Start of the range
+ * @param size Number of bytes in the range
+ * @return Number of newline characters
+ */
+size_t count_newlines(const char* data, size_t size);
+
+/**
+ * @brief Lazily maps byte offsets in a buffer to 1-based line and column numbers.
+ *
+ * Nothing is computed until a position is requested. Each lookup only counts the newlines
+ * between the previous lookup and the new offset, so resolving findings in ascending order
+ * costs a single vectorized pass over the part of the buffer that precedes the last finding.
+ */
+class LineCounter {
+public:
+    struct Position {
+        size_t line;
+        size_t column;
+    };
+
+    /**
+     * @brief Constructor for LineCounter
+     * @param buffer_ Buffer the offsets refer to; must outlive the counter
+     * @param first_line Line number of the first byte of the buffer
+     */
+    explicit LineCounter(std::string_view buffer_, size_t first_line = 1);
+
+    /**
+     * @brief Resolve a byte offset to its line and column
+     * @param offset Offset into the buffer (ascending lookups are cheapest)
+     * @return 1-based line and column of the offset
+     */
+    Position locate(size_t offset);
+
+private:
+    std::string_view buffer;
+    size_t base_line;
+    size_t counted_to = 0;   // offsets before this have been counted
+    size_t line = 0;         // line containing counted_to
+    size_t line_start = 0;   // offset of the first byte of that line
+};
+
+/**
+ * @brief Line and column tracking for streamed input.
+ *
+ * The input is seen through a window that moves forward, so the start of the current line
+ * may already have left it. Lookups must be ascending and must not fall before the window.
+ */
+class StreamLineCounter {
+public:
+    /**
+     * @brief Resolve a stream offset to its line and column
+     * @param window Bytes at stream offsets [base, base + window.size()); must include every
+     *               offset from the previous lookup up to offset
+     * @param base Stream offset of window[0]
+     * @param offset Stream offset to resolve, not less than the previous one
+     * @return 1-based line and column of the offset
+     */
+    LineCounter::Position locate(std::string_view window, size_t base, size_t offset);
+
+private:
+    size_t line = 1;
+    size_t line_start = 0;   // stream offset of the first byte of the current line
+    size_t counted_to = 0;   // stream offsets before this have been counted
+};
+
+#endif // LINECOUNTER_H
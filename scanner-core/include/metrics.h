@@ -0,0 +1,187 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <memory>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <functional>
+#include <ostream>
+#include <cstdint>
+#include <cstddef>
+
+using MetricLabels = std::vector<std::pair<std::string, std::string>>;
+
+/**
+ * @brief Monotonically increasing count; lock-free to update.
+ */
+class Counter {
+public:
+    void add(uint64_t n = 1) { count.fetch_add(n, std::memory_order_relaxed); }
+    uint64_t value() const { return count.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> count{0};
+};
+
+/**
+ * @brief Value that can go up and down, such as a queue depth.
+ */
+class Gauge {
+public:
+    void set(double v) { current.store(v, std::memory_order_relaxed); }
+    double value() const { return current.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<double> current{0.0};
+};
+
+/**
+ * @brief Latency histogram with fixed bucket bounds in seconds; lock-free to update.
+ */
+class Histogram {
+public:
+    /**
+     * @brief Constructor for Histogram
+     * @param bounds_ Ascending upper bounds in seconds (empty picks 100us .. 10s)
+     */
+    explicit Histogram(std::vector<double> bounds_ = {});
+
+    void observe(std::chrono::nanoseconds duration);
+
+    const std::vector<double>& bounds() const { return upper_bounds; }
+
+    /**
+     * @brief Cumulative count of observations at or below each bound; the last entry is +Inf
+     */
+    std::vector<uint64_t> cumulative_counts() const;
+
+    uint64_t count() const { return total.load(std::memory_order_relaxed); }
+    double sum_seconds() const { return static_cast<double>(sum_ns.load(std::memory_order_relaxed)) / 1e9; }
+
+    /**
+     * @brief Estimate a quantile by interpolating inside the bucket that contains it
+     * @param q Quantile in [0, 1]
+     * @return Estimated value in seconds (0 when empty)
+     */
+    double quantile(double q) const;
+
+private:
+    std::vector<double> upper_bounds;
+    std::unique_ptr<std::atomic<uint64_t>[]> buckets;  // one per bound plus +Inf
+    std::atomic<uint64_t> total{0};
+    std::atomic<uint64_t> sum_ns{0};
+};
+
+/**
+ * @brief Named metric families that can be rendered as Prometheus text or JSON.
+ *
+ * Registering a name and label set twice returns the same metric, so components can look
+ * their metrics up independently. Metrics live as long as the registry and their addresses
+ * never change, so the hot path keeps plain pointers and never takes the registry lock.
+ */
+class MetricsRegistry {
+public:
+    MetricsRegistry();
+
+    MetricsRegistry(const MetricsRegistry&) = delete;
+    MetricsRegistry& operator=(const MetricsRegistry&) = delete;
+
+    /**
+     * @brief Find or create a counter
+     * @throws std::invalid_argument if the name is already registered with another type
+     */
+    Counter& counter(const std::string& name, const std::string& help, const MetricLabels& labels = {});
+    Gauge& gauge(const std::string& name, const std::string& help, const MetricLabels& labels = {});
+    Histogram& histogram(const std::string& name, const std::string& help, const MetricLabels& labels = {});
+
+    /**
+     * @brief Seconds since the registry was created
+     */
+    double elapsed_seconds() const;
+
+    void write_prometheus(std::ostream& out) const;
+    void write_json(std::ostream& out) const;
+
+    /**
+     * @brief Write the metrics to a file, replacing it atomically
+     * @param file_path Destination path
+     * @param json true for the JSON summary, false for Prometheus text format
+     * @param error Receives a description of the problem on failure
+     * @return true on success
+     */
+    bool write_file(const std::string& file_path, bool json, std::string& error) const;
+
+private:
+    enum class Type { COUNTER, GAUGE, HISTOGRAM };
+
+    struct Series {
+        MetricLabels labels;
+        std::unique_ptr<Counter> counter;
+        std::unique_ptr<Gauge> gauge;
+        std::unique_ptr<Histogram> histogram;
+    };
+
+    struct Family {
+        std::string name;
+        std::string help;
+        Type type;
+        std::vector<Series> series;
+    };
+
+    std::vector<Family> families;
+    std::chrono::steady_clock::time_point start;
+    mutable std::mutex mutex;
+
+    Series& find_or_add(const std::string& name, const std::string& help, Type type, const MetricLabels& labels);
+};
+
+/**
+ * @brief Writes a registry to a Prometheus text file periodically and once more at stop().
+ */
+class MetricsExporter {
+public:
+    using RefreshCallback = std::function<void()>;
+
+    /**
+     * @brief Constructor for MetricsExporter; starts the export thread
+     * @param registry_ Metrics to export
+     * @param file_path_ Prometheus text file to (re)write
+     * @param interval_ Time between writes (0 writes only at stop)
+     * @param refresh_ Called before every write to update sampled gauges (may be empty)
+     */
+    MetricsExporter(const MetricsRegistry& registry_, std::string file_path_,
+                    std::chrono::milliseconds interval_, RefreshCallback refresh_ = nullptr);
+    ~MetricsExporter();
+
+    MetricsExporter(const MetricsExporter&) = delete;
+    MetricsExporter& operator=(const MetricsExporter&) = delete;
+
+    /**
+     * @brief Stop the export thread and write the final snapshot
+     * @param error Receives a description of the problem if the last write failed
+     * @return true if the final write succeeded
+     */
+    bool stop(std::string& error);
+
+private:
+    const MetricsRegistry& registry;
+    std::string file_path;
+    std::chrono::milliseconds interval;
+    RefreshCallback refresh;
+
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping = false;
+
+    void run();
+    bool export_once(std::string& error);
+};
+
+#endif // METRICS_H
@@ -0,0 +1,61 @@
+#ifndef OPTIONS_H
+#define OPTIONS_H
+
+#include <string>
+#include <vector>
+#include <optional>
+#include <cstddef>
+#include <cstdint>
+#include "shard.h"
+
+/**
+ * @brief Command-line options for the secret scanner CLI.
+ */
+struct ScanOptions {
+    std::string directory;
+    std::string batch_manifest;                 ///< file listing one scan root per line
+    std::string files_from;                     ///< scan the paths listed in this file ("-" = stdin) instead of walking
+    bool apply_filters = false;                 ///< with files_from: apply extension, glob and ignore filters to the list
+    ShardSpec shard;                            ///< scan only this shard of the candidate files
+    std::string partial_output;                 ///< where a shard writes its partial result
+    bool watch = false;                         ///< keep running and report finding deltas as files change
+    bool stream = false;                        ///< scan stdin (or the FIFO named by directory) as it arrives
+    bool redact = false;                        ///< with stream: copy the input to stdout with matches masked
+    bool merge = false;                         ///< "merge" subcommand: combine shard partials
+    std::vector<std::string> merge_inputs;      ///< partial result files to merge
+    std::vector<std::string> include_globs;
+    std::vector<std::string> exclude_globs;
+    size_t max_line_length = 0;                 ///< 0 keeps the scanner default
+    std::optional<long long> file_budget_ms;    ///< unset keeps the scanner default
+    std::string baseline_path;                  ///< suppress findings recorded in this baseline
+    std::string write_baseline_path;            ///< write every finding of this scan as a baseline
+    bool update_baseline = false;               ///< rewrite baseline_path from this scan
+    std::string metrics_file;                   ///< Prometheus text file written periodically and at exit
+    std::string metrics_json_path;              ///< JSON metrics summary written at exit
+    size_t metrics_interval = 10;               ///< seconds between metrics_file writes (0 = only at exit)
+    size_t readers = 0;                         ///< fixed reader threads (0 = adaptive)
+    size_t matchers = 0;                        ///< fixed matcher threads (0 = adaptive)
+    bool prioritize = false;                    ///< scan the highest risk files first
+    size_t max_findings = 0;                    ///< stop once this many findings are reported (0 = never)
+    std::string engine = "std";                 ///< regular expression engine, one of available_engines()
+    std::string trace_path;                     ///< write a Chrome trace of the scan to this file
+    bool trace_rules = false;                   ///< with trace_path: also record a span per rule per file
+    size_t decode_depth = 0;                    ///< nested base64/hex layers decoded and rescanned (0 = off)
+    std::optional<uint64_t> memory_budget;      ///< bytes for file buffers and results (unset = half the cgroup limit)
+    bool low_priority = false;                  ///< run with a higher nice value and idle I/O priority
+    bool group = false;                         ///< report each secret once per rule, with its locations
+    size_t max_locations = 10;                  ///< with group: locations listed per secret (0 = all)
+    std::optional<uint64_t> results_memory;     ///< findings held in memory before spilling to disk
+    bool show_help = false;
+};
+
+/**
+ * @brief Parse command-line arguments into ScanOptions
+ * @param argc Argument count as passed to main
+ * @param argv Argument vector as passed to main
+ * @return The parsed options
+ * @throws std::invalid_argument on unknown flags or missing flag values
+ */
+ScanOptions parse_options(int argc, char* argv[]);
+
+#endif // OPTIONS_H
@@ -0,0 +1,110 @@
+#ifndef PATHFILTER_H
+#define PATHFILTER_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include <cstdint>
+
+/**
+ * @brief Include/exclude glob lists compiled into a single path matcher.
+ *
+ * Patterns follow .gitignore conventions: a pattern without '/' matches at any depth,
+ * a leading '/' anchors it to the scan root, a trailing '/' restricts it to directories,
+ * "**" spans any number of components and '*', '?' and '[...]' work within one component.
+ * All patterns are merged into one trie of path components (literal children are a hash
+ * lookup, wildcard children a compiled component glob), so a path is evaluated in a single
+ * pass over its components no matter how many patterns were added.
+ */
+class PathFilter {
+public:
+    struct Match {
+        bool included = false;
+        bool excluded = false;
+    };
+
+    PathFilter();
+
+    /**
+     * @brief Build a filter that excludes the given directory names at any depth
+     * @param ignored_dirs Set of directory names to exclude
+     */
+    static PathFilter from_ignored_dirs(const std::unordered_set<std::string>& ignored_dirs);
+
+    /**
+     * @brief Add a glob selecting files that are scanned even without a known extension
+     * @param glob Glob pattern relative to the scan root
+     */
+    void add_include(const std::string& glob);
+
+    /**
+     * @brief Add a glob selecting files and directories that are never scanned
+     * @param glob Glob pattern relative to the scan root
+     */
+    void add_exclude(const std::string& glob);
+
+    /**
+     * @brief Load patterns from an ignore file (one per line, '#' comments, '!' marks an include)
+     * @param file_path Path to the ignore file
+     * @return true if the file was read, false if it does not exist or cannot be opened
+     */
+    bool load_ignore_file(const std::string& file_path);
+
+    /**
+     * @brief Match a path against every include and exclude pattern in one pass
+     * @param rel_path Path relative to the scan root, '/' separated
+     * @param is_dir Whether the path names a directory
+     * @return Which pattern lists matched the path or one of its parent directories
+     */
+    Match match(std::string_view rel_path, bool is_dir) const;
+
+    /**
+     * @brief Check if a directory should be pruned from traversal
+     * @param rel_path Directory path relative to the scan root
+     * @return true if the directory is excluded
+     */
+    bool is_excluded_dir(std::string_view rel_path) const;
+
+    /**
+     * @brief Decide whether a file should be scanned
+     * @param rel_path File path relative to the scan root
+     * @param has_valid_extension Whether the file has one of the default scan extensions
+     * @return true if the file is selected and not excluded
+     */
+    bool selects_file(std::string_view rel_path, bool has_valid_extension) const;
+
+    /**
+     * @brief Check whether any pattern has been added
+     */
+    bool empty() const { return pattern_count == 0; }
+
+private:
+    static constexpr uint32_t NONE = UINT32_MAX;
+    static constexpr uint8_t INCLUDE = 1;
+    static constexpr uint8_t EXCLUDE = 2;
+
+    struct ComponentGlob {
+        std::string pattern;
+        bool matches(std::string_view component) const;
+    };
+
+    struct Node {
+        std::unordered_map<std::string, uint32_t> literal_children;
+        std::vector<std::pair<ComponentGlob, uint32_t>> glob_children;
+        uint32_t globstar_child = NONE;
+        bool is_globstar = false;
+        uint8_t accept_any = 0;  // pattern ends here, matches files and directories
+        uint8_t accept_dir = 0;  // pattern ends here with a trailing '/'
+    };
+
+    std::vector<Node> nodes;
+    size_t pattern_count = 0;
+
+    void add_pattern(const std::string& glob, uint8_t kind);
+    uint32_t child_for(uint32_t parent, const std::string& component);
+    void add_closure(uint32_t state, std::vector<uint32_t>& states) const;
+};
+
+#endif // PATHFILTER_H
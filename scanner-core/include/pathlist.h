@@ -0,0 +1,85 @@
+#ifndef PATHLIST_H
+#define PATHLIST_H
+
+#include <string>
+#include <string_view>
+#include <functional>
+#include <cstddef>
+
+/**
+ * @brief Splits a list of paths, as printed by git ls-files -z, find -print0 or git diff
+ *        --name-only, into single paths while it is still arriving.
+ *
+ * Paths are separated by NUL bytes or by newlines. With Separator::detect, whichever of
+ * the two appears first decides for the whole list, so NUL-separated names may contain
+ * newlines as long as the first one does not. In newline mode a trailing '\r' is dropped.
+ * Empty entries are skipped.
+ */
+class PathListSplitter {
+public:
+    using PathCallback = std::function<void(std::string_view path)>;
+
+    enum class Separator {
+        detect,
+        nul,
+        newline,
+    };
+
+    /**
+     * @brief Constructor for PathListSplitter
+     * @param separator_ Separator of the list, or detect to pick it from the first one seen
+     */
+    explicit PathListSplitter(Separator separator_ = Separator::detect) : separator(separator_) {}
+
+    /**
+     * @brief Split the next chunk of the list; a path cut by the chunk end is kept for the next call
+     * @param data Next bytes of the list
+     * @param on_path Called with every path completed by this chunk
+     */
+    void feed(std::string_view data, const PathCallback& on_path);
+
+    /**
+     * @brief Report the last path when the list does not end with a separator
+     */
+    void finish(const PathCallback& on_path);
+
+    /**
+     * @brief Separator in use; detect until one has been seen
+     */
+    Separator get_separator() const { return separator; }
+
+private:
+    Separator separator;
+    std::string partial;
+
+    void emit(std::string_view path, const PathCallback& on_path) const;
+};
+
+/**
+ * @brief Read a path list from a file descriptor until end of input
+ *
+ * Paths are passed to on_path as soon as they are complete, so a caller can start work
+ * before a slow producer such as a pipe has finished the list.
+ *
+ * @param fd Descriptor to read from; it is not closed
+ * @param on_path Called with each path
+ * @param separator Separator of the list (see PathListSplitter)
+ * @return false if reading failed; paths read before the error have been reported
+ */
+bool read_path_list(int fd, const PathListSplitter::PathCallback& on_path,
+                    PathListSplitter::Separator separator = PathListSplitter::Separator::detect);
+
+/**
+ * @brief Where the root-relative part of a path starts
+ *
+ * A listed file may lie outside the scan root. Such a path has no relative form and is
+ * used as given, so it is reported, hashed to a shard and fingerprinted the same way on
+ * every machine that sees the same path.
+ *
+ * @param path Normalized file path
+ * @param root Scan root, with or without a trailing slash
+ * @return Length of the root and its separator when path is under root, otherwise 0
+ */
+size_t root_relative_offset(std::string_view path, std::string_view root);
+
+#endif // PATHLIST_H
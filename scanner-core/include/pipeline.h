@@ -0,0 +1,194 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <functional>
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+#include "boundedqueue.h"
+#include "controller.h"
+#include "scanner.h"
+#include "metrics.h"
+#include "resources.h"
+
+/**
+ * @brief Sizes of the scan pipeline stages and the queues between them.
+ */
+struct PipelineConfig {
+    size_t readers = 2;          ///< threads reading file contents (initial count when adaptive)
+    size_t matchers = 0;         ///< threads running the patterns (0 picks available_cpus())
+    size_t path_capacity = 1024; ///< discovered paths waiting to be read
+    size_t buffer_capacity = 0;  ///< file buffers waiting to be matched (0 picks 2 per matcher)
+    MetricsRegistry* metrics = nullptr; ///< receives stage latencies and byte counts (may be null)
+    MemoryBudget* memory = nullptr;     ///< bounds the bytes of file buffers in flight (may be null)
+
+    bool adaptive = false;       ///< let a controller resize both stages at runtime
+    size_t max_readers = 0;      ///< adaptive upper bound (0 picks 4 per CPU, at most 64)
+    size_t max_matchers = 0;     ///< adaptive upper bound (0 picks available_cpus())
+    std::chrono::milliseconds control_interval{250}; ///< time between controller decisions
+};
+
+/**
+ * @brief Bounded discover -> read -> match -> report pipeline.
+ *
+ * Discovered paths are submitted into a fixed-capacity queue drained by reader threads,
+ * whose file buffers go through a second fixed-capacity queue to the matcher threads.
+ * Each file's matches are reported together as one FindingBuffer through the scanner's
+ * report_findings, which the CLI overrides to collect them. Every queue is bounded, so
+ * memory stays flat regardless of how many files are submitted, and a full queue blocks
+ * the previous stage instead of growing. Completion is tracked with counters.
+ *
+ * With a MemoryBudget, readers reserve a file's size before reading it and the reservation
+ * is returned once the file is matched, so buffers in flight stay under the budget however
+ * large the files are. A file larger than the whole budget is streamed instead.
+ *
+ * Each file may name its own scanner, so one pipeline can serve several scan roots with
+ * different report sinks while its threads stay busy across root boundaries.
+ *
+ * In adaptive mode every stage starts its maximum number of threads, but only the first
+ * N of each stage take work; the rest stay parked. A controller thread samples read
+ * latency, utilization and queue depths and moves N up or down (see ConcurrencyController).
+ */
+class ScanPipeline {
+public:
+    using FileCallback = std::function<void(const std::string& path, const SecretScanner& scanner)>;
+
+    /**
+     * @brief Constructor for ScanPipeline; starts the stage threads
+     * @param scanner_ Scanner used for files submitted without one
+     * @param config Stage and queue sizes
+     * @param on_file_done_ Called with the file and its scanner after each submitted file has
+     *                      been processed (may be empty)
+     */
+    ScanPipeline(const SecretScanner& scanner_, PipelineConfig config = {},
+                 FileCallback on_file_done_ = nullptr);
+    ~ScanPipeline();
+
+    ScanPipeline(const ScanPipeline&) = delete;
+    ScanPipeline& operator=(const ScanPipeline&) = delete;
+
+    /**
+     * @brief Submit a discovered file, blocking while the path queue is full
+     * @param file_path Path of the file to scan
+     * @return false if the pipeline was cancelled and the file was dropped
+     */
+    bool submit(std::string file_path);
+
+    /**
+     * @brief Submit a discovered file to be read and matched by a specific scanner
+     * @param file_path Path of the file to scan
+     * @param job_scanner Scanner that reads the file and receives its findings; must outlive
+     *                    the file's completion
+     * @return false if the pipeline was cancelled and the file was dropped
+     */
+    bool submit(std::string file_path, const SecretScanner& job_scanner);
+
+    /**
+     * @brief Drop every file that has not started matching yet (safe from any thread)
+     *
+     * Files already being matched finish normally. Dropped files, and files submitted
+     * afterwards, count as completed and cancelled but are not passed to on_file_done.
+     */
+    void cancel();
+
+    /**
+     * @brief Stop accepting files, drain every stage and join the threads
+     */
+    void finish();
+
+    size_t files_submitted() const { return submitted.load(); }
+    size_t files_completed() const { return completed.load(); }
+    size_t files_unreadable() const { return unreadable.load(); }
+    size_t files_cancelled() const { return cancelled_files.load(); }
+    bool cancelled() const { return cancel_requested.load(); }
+    size_t active_readers() const { return readers_active.load(); }
+    size_t active_matchers() const { return matchers_active.load(); }
+
+    /**
+     * @brief Copy the current queue depths into the metrics registry (no-op without one)
+     */
+    void sample_metrics();
+
+private:
+    struct Job {
+        std::string path;
+        const SecretScanner* scanner = nullptr;
+    };
+
+    struct FileBuffer {
+        std::string path;
+        const SecretScanner* scanner = nullptr;
+        std::string content;
+        bool stream = false;     // too large to hold; the matcher streams it from disk
+        uint64_t reserved = 0;   // bytes held in the memory budget until the file is matched
+        std::chrono::steady_clock::time_point queued;
+    };
+
+    // null when the pipeline runs without a metrics registry
+    struct Instruments {
+        Counter* files_scanned = nullptr;
+        Counter* files_unreadable = nullptr;
+        Counter* bytes_read = nullptr;
+        Histogram* read_latency = nullptr;
+        Histogram* queue_wait = nullptr;
+        Histogram* match_latency = nullptr;
+        Gauge* path_depth = nullptr;
+        Gauge* buffer_depth = nullptr;
+        Gauge* buffer_memory = nullptr;
+        Gauge* result_memory = nullptr;
+    };
+
+    const SecretScanner& scanner;
+    FileCallback on_file_done;
+    MemoryBudget* memory;
+    Instruments instruments;
+
+    BoundedQueue<Job> paths;
+    BoundedQueue<FileBuffer> buffers;
+    std::vector<std::thread> reader_threads;
+    std::vector<std::thread> matcher_threads;
+
+    std::atomic<size_t> submitted{0};
+    std::atomic<size_t> completed{0};
+    std::atomic<size_t> unreadable{0};
+    std::atomic<size_t> readers_running{0};
+    std::atomic<size_t> cancelled_files{0};
+    std::atomic<bool> cancel_requested{false};
+    bool finished = false;
+
+    // workers whose index is at or above the active count stay parked
+    std::atomic<size_t> readers_active{0};
+    std::atomic<size_t> matchers_active{0};
+    std::mutex park_mutex;
+    std::condition_variable park_cv;
+    bool readers_closing = false;
+    bool matchers_closing = false;
+
+    // totals sampled by the controller
+    std::atomic<uint64_t> files_read{0};
+    std::atomic<uint64_t> bytes_read{0};
+    std::atomic<uint64_t> read_busy_ns{0};
+    std::atomic<uint64_t> match_busy_ns{0};
+
+    std::thread controller_thread;
+    std::mutex controller_mutex;
+    std::condition_variable controller_cv;
+    bool controller_stop = false;
+    Gauge* reader_gauge = nullptr;
+    Gauge* matcher_gauge = nullptr;
+
+    void reader_loop(size_t index);
+    void matcher_loop(size_t index);
+    void wait_until_active(size_t index, const std::atomic<size_t>& active, const bool& closing);
+    void set_active(size_t readers, size_t matchers);
+    void control_loop(ConcurrencyController controller, std::chrono::milliseconds interval);
+    void complete(const std::string& path, const SecretScanner& job_scanner);
+    void drop();
+    void release(FileBuffer& buffer);
+};
+
+#endif // PIPELINE_H
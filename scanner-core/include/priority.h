@@ -0,0 +1,45 @@
+#ifndef PRIORITY_H
+#define PRIORITY_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief A file that survived filtering, with what is known about it before reading.
+ */
+struct RiskCandidate {
+    std::string path;          ///< path handed to the pipeline
+    size_t rel_offset = 0;     ///< where the root-relative part of path starts
+    uint64_t size = 0;         ///< file size in bytes
+    double age_days = 0;       ///< days since the last modification (negative when unknown)
+    int score = 0;             ///< filled in by order_by_risk
+};
+
+/**
+ * @brief How likely a file is to hold a secret, from its path, size and age alone.
+ *
+ * Secret-bearing names (.env files, credentials, private keys, tfvars) score highest,
+ * then names mentioning secrets or tokens, then configuration formats and directories.
+ * Recently modified and small files get a bonus, so a dirty repository tends to produce
+ * its first finding after reading only a handful of files.
+ *
+ * @param rel_path Path relative to the scan root
+ * @param size File size in bytes
+ * @param age_days Days since the last modification (negative when unknown)
+ * @return Score; higher means scan earlier
+ */
+int risk_score(std::string_view rel_path, uint64_t size, double age_days);
+
+/**
+ * @brief Score every candidate and sort them highest risk first
+ *
+ * Ties keep path order, so the schedule is the same on every run over the same tree.
+ *
+ * @param candidates Files to order; their score fields are set
+ */
+void order_by_risk(std::vector<RiskCandidate>& candidates);
+
+#endif // PRIORITY_H
@@ -5,6 +5,12 @@
 #include <vector>
 #include <regex>
 #include <string>
+#include "ruleset.h"
+
+/**
+ * @brief Source form of the built-in rules used for detecting secrets in source code.
+ */
+extern const std::vector<RuleDefinition> secret_rule_definitions;
 
 /**
  * @brief Contains patterns used for detecting secrets in source code.
@@ -0,0 +1,50 @@
+#ifndef REPORT_H
+#define REPORT_H
+
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <cstddef>
+
+/**
+ * @brief A finding as it appears in reports.
+ */
+struct FindingRecord {
+    std::string file;
+    int line = 0;
+    int column = 0;
+    size_t offset = 0;
+    std::string type;
+    std::string match;
+};
+
+/**
+ * @brief Report order: by file, then offset, then rule name
+ */
+bool finding_less(const FindingRecord& a, const FindingRecord& b);
+
+/**
+ * @brief Escape a string for use inside a JSON string literal
+ * @param s Raw bytes
+ * @return Escaped text without the surrounding quotes
+ */
+std::string json_escape(std::string_view s);
+
+/**
+ * @brief Render a finding as a single-line JSON object
+ * @param finding Finding to render
+ * @return {"file":...,"line":...,"column":...,"offset":...,"type":...,"match":...}
+ */
+std::string finding_to_json(const FindingRecord& finding);
+
+using JsonFields = std::unordered_map<std::string, std::string>;
+
+/**
+ * @brief Parse a flat single-line JSON object of string, number and boolean members
+ * @param line Text of the object
+ * @param fields Receives each member; strings are unescaped, other values are kept as written
+ * @return false if the text is not such an object
+ */
+bool parse_json_object(std::string_view line, JsonFields& fields);
+
+#endif // REPORT_H
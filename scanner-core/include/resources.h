@@ -0,0 +1,134 @@
+#ifndef RESOURCES_H
+#define RESOURCES_H
+
+#include <string>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief CPU and memory the process may use, as granted by its cgroup and CPU affinity.
+ */
+struct ResourceLimits {
+    size_t host_cpus = 1;        ///< CPUs of the machine (hardware concurrency)
+    size_t affinity_cpus = 0;    ///< CPUs the process may be scheduled on (0 = unknown)
+    double cpu_quota = 0;        ///< CPUs worth of CFS quota per period (0 = no quota)
+    uint64_t memory_limit = 0;   ///< bytes the cgroup may use before reclaim or OOM (0 = no limit)
+    int cgroup_version = 0;      ///< 1 or 2 for the hierarchy the limits came from, 0 if none was found
+
+    /**
+     * @brief Worker threads that fit the limits: the quota rounded down, at least one, and
+     *        never more than the CPUs the process can run on
+     */
+    size_t cpus() const;
+};
+
+/**
+ * @brief Read the CPU quota and memory limit of the cgroup a process belongs to
+ *
+ * The process's cgroup is looked up in proc_cgroup (the "0::/path" line on cgroup v2, the
+ * cpu and memory controller lines on v1) and its directory under cgroup_root is read:
+ * cpu.max, memory.max and memory.high on v2, cpu.cfs_quota_us, cpu.cfs_period_us and
+ * memory.limit_in_bytes on v1. Limits of parent cgroups apply to their children, so every
+ * directory up to the root is read and the tightest limit wins. A cgroup path that does not
+ * exist under the mount, as when a container sees its own cgroup as the root, falls back to
+ * the mount itself. Missing files mean no limit.
+ *
+ * @param cgroup_root Mount point of the cgroup file system
+ * @param proc_cgroup File listing the process's cgroups
+ * @return The limits; host and affinity CPU counts are those of the calling process
+ */
+ResourceLimits read_resource_limits(const std::string& cgroup_root = "/sys/fs/cgroup",
+                                    const std::string& proc_cgroup = "/proc/self/cgroup");
+
+/**
+ * @brief Limits of the running process, read once on first use
+ */
+const ResourceLimits& resource_limits();
+
+/**
+ * @brief Default worker count for CPU-bound stages: resource_limits().cpus()
+ */
+size_t available_cpus();
+
+/**
+ * @brief Parse a byte count such as "512M", "2G", "64k" or "1048576"
+ * @param text Number with an optional K, M or G suffix (powers of 1024, case-insensitive,
+ *             optionally followed by "B" or "iB")
+ * @param bytes Receives the byte count
+ * @return false if the text is not a byte count
+ */
+bool parse_byte_size(const std::string& text, uint64_t& bytes);
+
+/**
+ * @brief Run the calling process at lower CPU and I/O priority
+ *
+ * Sets a nice value of 10 and, on Linux, the idle I/O scheduling class. Both are per
+ * thread on Linux and inherited by threads created afterwards, so this must be called
+ * before any worker threads start.
+ *
+ * @param error Receives a message when a priority could not be changed
+ * @return true if both priorities were lowered
+ */
+bool lower_process_priority(std::string& error);
+
+/**
+ * @brief Byte budget shared by file buffers in flight and collected results.
+ *
+ * Readers acquire the size of a file before reading it and matchers release it once the
+ * file is matched, so the total held by buffers waiting in queues or being matched stays
+ * under the limit. Results are charged without blocking: they reduce what is left for
+ * buffers, until results are released again. A reader is always let through when no other
+ * buffer is held, so one file larger than what is left still makes progress instead of
+ * waiting forever.
+ */
+class MemoryBudget {
+public:
+    /**
+     * @brief Constructor for MemoryBudget
+     * @param limit_ Bytes that may be held at once (0 = unlimited, nothing blocks)
+     */
+    explicit MemoryBudget(uint64_t limit_ = 0) : limit_bytes(limit_) {}
+
+    MemoryBudget(const MemoryBudget&) = delete;
+    MemoryBudget& operator=(const MemoryBudget&) = delete;
+
+    /**
+     * @brief Reserve bytes for a file buffer, blocking until they fit
+     * @param bytes Size of the buffer
+     */
+    void acquire(uint64_t bytes);
+
+    /**
+     * @brief Return bytes reserved with acquire
+     */
+    void release(uint64_t bytes);
+
+    /**
+     * @brief Account bytes held by results; never blocks
+     */
+    void charge(uint64_t bytes);
+
+    /**
+     * @brief Return bytes accounted with charge
+     */
+    void discharge(uint64_t bytes);
+
+    uint64_t limit() const { return limit_bytes; }
+    uint64_t in_use() const;
+    uint64_t buffer_bytes() const;
+    uint64_t result_bytes() const;
+    uint64_t peak() const;
+
+private:
+    const uint64_t limit_bytes;
+    mutable std::mutex mutex;
+    std::condition_variable cv;
+    uint64_t buffers = 0;
+    uint64_t results = 0;
+    size_t buffers_held = 0;
+    uint64_t peak_bytes = 0;
+};
+
+#endif // RESOURCES_H
@@ -0,0 +1,121 @@
+#ifndef RULESET_H
+#define RULESET_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <regex>
+#include <utility>
+#include <unordered_map>
+#include <cstdint>
+#include <cstddef>
+#include "pathfilter.h"
+
+/**
+ * @brief Source form of a detection rule.
+ */
+struct RuleDefinition {
+    std::string name;
+    std::string pattern;
+    bool icase = false;
+    std::string end = {};   ///< closing pattern of a rule that spans lines, such as a PEM END marker (optional)
+    /// file name globs the rule is limited to; a leading '!' excludes instead (empty = every file)
+    std::vector<std::string> scope = {};
+};
+
+/**
+ * @brief Facts derived from a pattern's source that let the matcher bound its work.
+ */
+struct PatternInfo {
+    std::string prefix;    ///< literal text every match starts with (empty when there is none)
+    size_t max_length = 0; ///< longest possible match in bytes
+    bool bounded = false;  ///< false when the pattern has an unbounded repetition
+};
+
+/**
+ * @brief Derive the literal prefix and maximum match length of an ECMAScript pattern
+ * @param pattern Regular expression source
+ * @return The derived facts; unknown constructs make the pattern unbounded
+ */
+PatternInfo analyze_pattern(const std::string& pattern);
+
+/**
+ * @brief A compiled rule together with the facts derived from its source.
+ */
+struct Rule {
+    std::string name;
+    std::string pattern;   ///< source of regex; empty when the rule was given precompiled
+    std::regex regex;
+    bool icase = false;
+    PatternInfo info;
+
+    // rules with a closing pattern run from the opening match through the closing one
+    bool spans_lines = false;
+    std::string end_pattern;
+    std::regex end;
+    PatternInfo end_info;
+
+    std::vector<std::string> scope;
+};
+
+/**
+ * @brief Immutable set of compiled rules.
+ *
+ * A RuleSet is never modified after construction, so a single instance can be shared by
+ * any number of scanners and threads.
+ *
+ * Rule scopes are compiled into an index from file extension and file name to the subset
+ * of rules that apply, so picking the rules for a file is one or two hash lookups. Scope
+ * entries of the form "*.ext" and plain file names are indexed and compared without case;
+ * any other glob is matched against the file name for each file.
+ */
+class RuleSet {
+public:
+    /**
+     * @brief Compile rules from their source form
+     * @param definitions Rule names and pattern sources
+     * @throws std::regex_error if a pattern does not compile
+     */
+    explicit RuleSet(const std::vector<RuleDefinition>& definitions);
+
+    /**
+     * @brief Wrap already compiled patterns; without sources no prefix or length is known
+     * @param patterns Vector of pattern name and regex pairs
+     */
+    explicit RuleSet(const std::vector<std::pair<std::string, std::regex>>& patterns);
+
+    const std::vector<Rule>& rules() const { return rule_list; }
+    size_t size() const { return rule_list.size(); }
+
+    /**
+     * @brief Indices of every rule, in rule order
+     */
+    const std::vector<uint32_t>& all_rules() const { return all; }
+
+    /**
+     * @brief Indices of the rules whose scope includes a file, in rule order
+     * @param path Path of the file; only its file name is looked at
+     * @param scratch Storage for answers that are not precomputed
+     * @return A precomputed list, or scratch filled with the answer
+     */
+    const std::vector<uint32_t>& rules_for(std::string_view path, std::vector<uint32_t>& scratch) const;
+
+private:
+    std::vector<Rule> rule_list;
+
+    // scope index; see rules_for
+    std::vector<uint32_t> all;
+    std::vector<uint32_t> unlisted;   // files whose extension and name no indexed scope mentions
+    std::unordered_map<std::string, std::vector<uint32_t>> by_extension;
+    std::unordered_map<std::string, std::vector<uint32_t>> by_name;
+    struct GlobScope {
+        uint32_t rule;
+        PathFilter filter;
+        bool has_include;
+    };
+    std::vector<GlobScope> glob_scopes;
+
+    void build_scope_index();
+};
+
+#endif // RULESET_H
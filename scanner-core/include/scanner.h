@@ -2,20 +2,50 @@
 #define SCANNER_H
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <unordered_set>
 #include <filesystem>
 #include <regex>
 #include <utility>
 #include <mutex>
+#include <memory>
+#include <chrono>
+#include <istream>
+#include <cstdint>
+#include <functional>
+#include "ruleset.h"
+#include "engine.h"
+#include "finding.h"
+#include "linecounter.h"
 
 namespace fs = std::filesystem;
 
+/**
+ * @brief Limits that keep a single pathological file from stalling a worker.
+ */
+struct ScanLimits {
+    /// a file whose longest line is over guard_window and at most this long is searched whole with
+    /// plain regex_search, which the file budget cannot interrupt; every other file uses the guarded
+    /// matcher, so values up to guard_window leave plain search off
+    size_t long_line_length = 4096;
+    size_t guard_window = 4096;                      ///< longest match tried for unbounded rules on long lines
+    size_t block_span = 16 * 1024;                   ///< longest match of a rule that spans lines
+    std::chrono::milliseconds file_budget{10000};    ///< CPU time allowed per file (0 = unlimited)
+    uint64_t stream_threshold = 8 * 1024 * 1024;     ///< larger files are scanned in windows, not read whole
+    size_t stream_window = 1024 * 1024;              ///< bytes accepted per window when streaming
+    size_t decode_depth = 0;                         ///< nested base64/hex layers decoded and rescanned (0 = off)
+    size_t decode_min_length = 24;                   ///< shortest encoded run that is decoded
+    size_t decode_budget = 64 * 1024;                ///< decoded bytes per file, plus a quarter of the file size
+};
+
 class SecretScanner {
 private:
     std::unordered_set<std::string> ignored_dirs;
     std::unordered_set<std::string> valid_extensions;
-    std::vector<std::pair<std::string, std::regex>> secret_patterns;
+    std::shared_ptr<const RuleSet> rules;
+    std::shared_ptr<const MatchEngine> engine;
+    ScanLimits limits;
     mutable std::mutex output_mutex;
 
 public:
@@ -31,6 +61,42 @@ public:
         const std::vector<std::pair<std::string, std::regex>>& secret_patterns_
     );
 
+    /**
+     * @brief Constructor for SecretScanner sharing an already compiled rule set
+     * @param ignored_dirs_ Set of directory names to ignore during scanning
+     * @param valid_extensions_ Set of valid file extensions to scan
+     * @param rules_ Compiled rules; the same instance may be shared by many scanners
+     */
+    SecretScanner(
+        const std::unordered_set<std::string>& ignored_dirs_,
+        const std::unordered_set<std::string>& valid_extensions_,
+        std::shared_ptr<const RuleSet> rules_
+    );
+
+    virtual ~SecretScanner() = default;
+
+    /**
+     * @brief Replace the per-file guard limits
+     * @param limits_ New limits
+     */
+    void set_limits(const ScanLimits& limits_) { limits = limits_; }
+
+    const ScanLimits& get_limits() const { return limits; }
+
+    const RuleSet& get_rules() const { return *rules; }
+
+    /**
+     * @brief Match with another regular expression engine
+     *
+     * The scanner uses the engine's rule set from now on. Scanners start with the "std"
+     * engine built for the rules they were constructed with.
+     *
+     * @param engine_ Engine to use; see make_engine
+     */
+    void set_engine(std::shared_ptr<const MatchEngine> engine_);
+
+    const MatchEngine& get_engine() const { return *engine; }
+
     /**
      * @brief Check if a directory path should be ignored
      * @param path The filesystem path to check
@@ -53,20 +119,163 @@ public:
     bool is_git_ignored(const std::string& file) const;
 
     /**
-     * @brief Scan a single file for secrets
+     * @brief Scan a single file for secrets, streaming it when it is large
      * @param file_path Path to the file to scan
      */
     void scan_file(const std::string& file_path) const;
 
+    /**
+     * @brief Scan input of any length with a fixed-size sliding window
+     *
+     * The input is read stream_window bytes at a time into an IncrementalScan. Long lines
+     * are split into windows that overlap by the longest possible match, and matches are
+     * only accepted in the part of a window the next one does not cover. The findings are
+     * therefore the same as scanning the whole input at once with the guarded matcher.
+     * Memory use is about twice stream_window plus that overlap, whatever the file or
+     * line length.
+     *
+     * @param file_path Path reported with each finding
+     * @param input Stream read until end of input
+     */
+    void scan_stream(const std::string& file_path, std::istream& input) const;
+
+    /**
+     * @brief Check whether a file is large enough to be streamed instead of read whole
+     * @param file_path Path to the file
+     * @param size Receives the file size when not null
+     * @return true if the file is larger than the stream threshold
+     */
+    bool should_stream(const std::string& file_path, uint64_t* size = nullptr) const;
+
+    /**
+     * @brief Read a whole file into memory
+     * @param file_path Path to the file to read
+     * @param content Receives the file contents
+     * @return true on success, false if the file cannot be opened
+     */
+    bool read_file(const std::string& file_path, std::string& content) const;
+
+    /**
+     * @brief Scan file contents that have already been read
+     *
+     * Only the rules whose scope includes the file name of file_path are run.
+     *
+     * @param file_path Path reported with each finding
+     * @param content Contents of the file; only borrowed for the duration of the call
+     */
+    void scan_buffer(const std::string& file_path, std::string_view content) const;
+
+    /**
+     * @brief Scan file contents and append the findings to a caller-owned buffer
+     *
+     * Findings are appended in offset order with their line, column and matched text
+     * resolved; nothing is reported through the virtual hooks. A buffer that is cleared
+     * and reused between calls makes the scan free of per-finding heap allocations.
+     *
+     * With ScanLimits::decode_depth set, base64 and hex runs are decoded and the rules run
+     * over the decoded bytes too, up to decode_budget decoded bytes plus a quarter of the
+     * content size. Streamed files are not decoded.
+     *
+     * @param content Contents of the file; only borrowed for the duration of the call
+     * @param file_id Id stored in each appended finding
+     * @param out Buffer the findings are appended to
+     * @param scope_path Path whose file name picks the rules to run (see RuleSet::rules_for);
+     *                   empty runs every rule
+     * @return false if the CPU budget ran out and the file was only partially scanned
+     */
+    bool scan_buffer(std::string_view content, uint32_t file_id, FindingBuffer& out,
+                     std::string_view scope_path = {}) const;
+
     /**
      * @brief Virtual method for reporting found secrets (can be overridden)
      * @param file_path Path to the file containing the secret
      * @param line_number Line number where the secret was found
+     * @param column 1-based column of the first character of the match
+     * @param offset Byte offset of the match from the start of the file
      * @param pattern_name Name of the pattern that matched
      * @param match_str The actual matched string
      */
-    virtual void report_secret(const std::string& file_path, int line_number, 
+    virtual void report_secret(const std::string& file_path, int line_number, int column, size_t offset,
                               const std::string& pattern_name, const std::string& match_str) const;
+
+    /**
+     * @brief Virtual method for reporting all findings of one file or stream window (can be overridden)
+     *
+     * The default implementation calls report_secret once per finding. Overriding this
+     * instead avoids building a std::string for every match.
+     *
+     * @param file_path Path to the file containing the secrets
+     * @param findings Findings in offset order; only valid for the duration of the call
+     */
+    virtual void report_findings(const std::string& file_path, const FindingBuffer& findings) const;
+
+    /**
+     * @brief Virtual method for reporting a file whose scan stopped early (can be overridden)
+     * @param file_path Path to the file that was only partially scanned
+     * @param reason Why the scan stopped
+     */
+    virtual void report_partial_scan(const std::string& file_path, const std::string& reason) const;
+};
+
+/**
+ * @brief Scan of input that arrives piece by piece, such as a pipe or a growing log.
+ *
+ * Input is accepted one complete line at a time, so a finding is reported as soon as the
+ * newline after it arrives. A line longer than the stream window is accepted in windows
+ * that overlap by the longest possible match, as in SecretScanner::scan_stream. A
+ * multi-line block, such as a PEM private key, is held back until its END marker arrives
+ * or the block span is exhausted. Memory stays bounded by the stream window plus the
+ * block span. Findings go to the scanner's report_findings.
+ */
+class IncrementalScan {
+public:
+    using Output = std::function<void(std::string_view)>;
+
+    /**
+     * @brief Constructor for IncrementalScan
+     * @param scanner_ Scanner whose rules, limits and report hooks are used
+     * @param name_ Path reported with each finding; its file name also picks the rules to run
+     * @param redacted_ Receives the input with every match replaced by "[REDACTED:<rule>]",
+     *                  in order and as soon as it is scanned (may be empty)
+     */
+    IncrementalScan(const SecretScanner& scanner_, std::string name_, Output redacted_ = nullptr);
+
+    /**
+     * @brief Scan the next piece of input
+     * @param data Bytes that follow everything fed so far
+     * @return false once the CPU budget has run out; later input is ignored
+     */
+    bool feed(std::string_view data);
+
+    /**
+     * @brief Scan whatever is still held back and report a partial scan if the budget ran out
+     */
+    void finish();
+
+    bool stopped() const { return budget_exceeded; }
+    uint64_t bytes_scanned() const { return accepted; }
+
+private:
+    const SecretScanner& scanner;
+    std::string name;
+    Output redacted;
+    std::vector<uint32_t> active;   // rules whose scope includes name
+    size_t overlap;
+    std::chrono::nanoseconds cpu_start;
+    std::vector<size_t> resume;
+    FindingBuffer findings;
+    std::string window;
+    size_t base = 0;            // stream offset of window[0]
+    size_t accepted = 0;        // stream offsets before this have been scanned
+    size_t emitted = 0;         // stream offsets before this have been passed to redacted
+    size_t redact_until = 0;    // stream offsets before this are masked in the output
+    StreamLineCounter lines;
+    bool budget_exceeded = false;
+
+    void scan(bool at_end);
+    size_t held_block(size_t accept_end) const;
+    void pass_through(size_t accept_end);
+    void copy_to(size_t target);
 };
 
 #endif // SCANNER_H
\ No newline at end of file
@@ -0,0 +1,113 @@
+#ifndef SCANNER_C_H
+#define SCANNER_C_H
+
+/*
+ * C interface to libscanner_core.
+ *
+ * Only plain C types cross this boundary and no C++ exception ever escapes it, so the
+ * library can be loaded from C, from other languages through their FFI, or into a process
+ * built with a different C++ runtime.
+ *
+ * Threading: a ruleset is immutable once created and may be shared by any number of
+ * scanners on any number of threads. A scanner is cheap to create and must only be used by
+ * one thread at a time; create one per worker.
+ */
+
+#include <stddef.h>
+
+#if defined(_WIN32)
+#  if defined(SCANNER_CORE_BUILD)
+#    define SS_API __declspec(dllexport)
+#  else
+#    define SS_API
+#  endif
+#elif defined(__GNUC__)
+#  define SS_API __attribute__((visibility("default")))
+#else
+#  define SS_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Result codes; negative values are errors. */
+#define SS_OK                     0
+#define SS_STOPPED                1  /* the callback asked to stop; remaining findings were dropped */
+#define SS_PARTIAL                2  /* the per-scan CPU budget ran out; findings may be incomplete */
+#define SS_ERR_INVALID_ARGUMENT (-1)
+#define SS_ERR_IO               (-2)
+#define SS_ERR_INTERNAL         (-3)
+
+typedef struct ss_ruleset ss_ruleset;
+typedef struct ss_scanner ss_scanner;
+
+/** Source form of a rule; strings are copied by ss_ruleset_new. */
+typedef struct ss_rule_def {
+    const char* name;
+    const char* pattern;  /* ECMAScript regular expression */
+    int icase;            /* non-zero for case-insensitive matching */
+} ss_rule_def;
+
+/**
+ * One finding. All pointers are only valid for the duration of the callback; match points
+ * into the scanned buffer and is not NUL-terminated.
+ */
+typedef struct ss_finding {
+    const char* rule;
+    const char* path;     /* path or label given to the scan call (never NULL) */
+    const char* match;
+    size_t match_len;
+    size_t offset;        /* byte offset of the match in the buffer */
+    size_t line;          /* 1-based */
+    size_t column;        /* 1-based */
+} ss_finding;
+
+/** Called once per finding in offset order; return non-zero to stop reporting. */
+typedef int (*ss_finding_cb)(const ss_finding* finding, void* user_data);
+
+/** Library version string, e.g. "1.0.0". */
+SS_API const char* ss_version(void);
+
+/** Human readable description of a result code. */
+SS_API const char* ss_strerror(int code);
+
+/** Ruleset with the built-in detection rules, or NULL on failure. */
+SS_API ss_ruleset* ss_ruleset_new_default(void);
+
+/**
+ * Compile a ruleset from rule definitions.
+ * On failure returns NULL and, when error is not NULL, writes a NUL-terminated message
+ * of at most error_size bytes.
+ */
+SS_API ss_ruleset* ss_ruleset_new(const ss_rule_def* rules, size_t count, char* error, size_t error_size);
+
+/** Number of rules in the set. */
+SS_API size_t ss_ruleset_size(const ss_ruleset* ruleset);
+
+/** Release the caller's handle; scanners created from it keep the rules alive. */
+SS_API void ss_ruleset_free(ss_ruleset* ruleset);
+
+/** Create a scanner over a ruleset, or NULL on failure. */
+SS_API ss_scanner* ss_scanner_new(const ss_ruleset* ruleset);
+
+/** CPU time allowed per scan call in milliseconds (0 = unlimited, default 10000). */
+SS_API int ss_scanner_set_budget_ms(ss_scanner* scanner, long long budget_ms);
+
+SS_API void ss_scanner_free(ss_scanner* scanner);
+
+/**
+ * Scan a buffer held by the caller; the buffer is not copied.
+ * label is reported as the finding path and may be NULL.
+ */
+SS_API int ss_scan_buffer(ss_scanner* scanner, const char* data, size_t len, const char* label,
+                          ss_finding_cb callback, void* user_data);
+
+/** Read and scan a file; returns SS_ERR_IO if it cannot be opened. */
+SS_API int ss_scan_path(ss_scanner* scanner, const char* path, ss_finding_cb callback, void* user_data);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SCANNER_C_H */
@@ -0,0 +1,111 @@
+#ifndef SHARD_H
+#define SHARD_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+#include "report.h"
+
+/**
+ * @brief Which part of a sharded scan this process runs.
+ */
+struct ShardSpec {
+    size_t index = 0;  ///< 0-based shard number
+    size_t count = 0;  ///< number of shards (0 = not sharded)
+
+    bool enabled() const { return count > 0; }
+};
+
+/**
+ * @brief Parse "i/N" with 0 <= i < N
+ * @param value Text of the --shard flag
+ * @return The parsed spec
+ * @throws std::invalid_argument on malformed or out-of-range values
+ */
+ShardSpec parse_shard_spec(const std::string& value);
+
+/**
+ * @brief A file that survived filtering and can be assigned to a shard.
+ */
+struct ShardCandidate {
+    std::string rel_path;  ///< path relative to the scan root
+    uint64_t size = 0;     ///< file size in bytes
+};
+
+/**
+ * @brief Stable 64-bit hash of a root-relative path (FNV-1a)
+ */
+uint64_t shard_path_hash(std::string_view rel_path);
+
+/**
+ * @brief Assign every candidate to a shard so that shards carry similar byte totals.
+ *
+ * Files are placed largest first onto the least loaded shard (longest processing time
+ * first), with the path hash and then the path breaking ties. The result depends only on
+ * the set of candidates, never on discovery order, so every node computes the same plan.
+ *
+ * @param candidates Files to distribute
+ * @param shard_count Number of shards (at least 1)
+ * @return Shard index for each candidate, in input order
+ */
+std::vector<size_t> assign_shards(const std::vector<ShardCandidate>& candidates, size_t shard_count);
+
+/**
+ * @brief Findings and statistics of one shard, with paths relative to the scan root.
+ */
+struct ShardPartial {
+    size_t shard = 0;
+    size_t shards = 0;
+    std::string root;
+    size_t candidates = 0;          ///< files eligible in the whole scan
+    size_t total_files = 0;         ///< files assigned to this shard
+    size_t files_scanned = 0;
+    size_t secrets_suppressed = 0;
+    uint64_t bytes = 0;             ///< bytes assigned to this shard
+    std::vector<FindingRecord> findings;
+    std::vector<std::pair<std::string, std::string>> partial_files;  ///< path and reason
+};
+
+/**
+ * @brief Visits findings one at a time, like FindingAggregator::for_each
+ */
+using FindingSource = std::function<bool(const std::function<void(const FindingRecord&)>& visit, std::string& error)>;
+
+/**
+ * @brief Receives each finding of a partial result as it is read
+ */
+using FindingSink = std::function<void(FindingRecord finding)>;
+
+/**
+ * @brief Write a partial result as NDJSON: a header line, then findings and partial files
+ * @param findings Where the findings come from, so a large result set never has to be held
+ *        in partial.findings (empty = write partial.findings)
+ * @return true on success; error describes the failure otherwise
+ */
+bool write_shard_partial(const std::string& file_path, const ShardPartial& partial, std::string& error,
+                         const FindingSource& findings = nullptr);
+
+/**
+ * @brief Read a partial result written by write_shard_partial
+ * @param on_finding Receives each finding instead of partial.findings, after the header
+ *        fields of partial are set (empty = collect them in partial.findings)
+ * @return true on success; error describes the failure otherwise
+ */
+bool read_shard_partial(const std::string& file_path, ShardPartial& partial, std::string& error,
+                        const FindingSink& on_finding = nullptr);
+
+/**
+ * @brief Combine the partials of every shard of one scan
+ * @param partials One partial per shard, in any order
+ * @param merged Receives the combined result with findings in report order; findings
+ *        passed to a FindingSink while reading are not part of it
+ * @param error Receives a description of missing, duplicate or mismatched shards
+ * @return true if the partials form a complete scan
+ */
+bool merge_shard_partials(const std::vector<ShardPartial>& partials, ShardPartial& merged, std::string& error);
+
+#endif // SHARD_H
@@ -12,7 +12,12 @@
 
 class ThreadPool {
 public:
-    explicit ThreadPool(size_t);
+    /**
+     * @brief Constructor for ThreadPool
+     * @param threads Number of worker threads
+     * @param max_queued Maximum number of pending tasks; enqueue blocks while the queue is full (0 = unbounded)
+     */
+    explicit ThreadPool(size_t threads, size_t max_queued = 0);
     ~ThreadPool();
 
     template<class F, class... Args>
@@ -25,6 +30,8 @@ private:
 
     std::mutex queue_mutex;
     std::condition_variable condition;
+    std::condition_variable space_available;
+    size_t max_queued;
     bool stop;
 };
 
@@ -42,6 +49,9 @@ auto ThreadPool::enqueue(F&& f, Args&&... args)
     {
         std::unique_lock<std::mutex> lock(queue_mutex);
 
+        if (max_queued)
+            space_available.wait(lock, [this] { return stop || tasks.size() < max_queued; });
+
         if (stop)
             throw std::runtime_error("enqueue on stopped ThreadPool");
 
@@ -0,0 +1,167 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief Records timed spans per thread and writes them as a Chrome trace.
+ *
+ * Each thread appends to its own ring of events, so recording takes no lock: a span costs
+ * two clock reads and one copy of its name and detail. A ring is allocated in chunks as its
+ * thread records, so threads that record little, such as idle workers, cost next to no
+ * memory. When a ring reaches its capacity its oldest events are overwritten and counted
+ * as dropped. The output
+ * is the Chrome trace event format ("X" complete events, one track per thread), which
+ * chrome://tracing and Perfetto open directly.
+ *
+ * Only one recorder is active at a time; TraceSpan finds it through active(), which is a
+ * single relaxed load, so instrumented code costs next to nothing while tracing is off.
+ */
+class TraceRecorder {
+public:
+    /**
+     * @brief Constructor for TraceRecorder
+     * @param record_rules_ Also record one span per rule per file (much more data)
+     * @param events_per_thread_ Ring capacity of each thread
+     */
+    explicit TraceRecorder(bool record_rules_ = false, size_t events_per_thread_ = 64 * 1024);
+    ~TraceRecorder();
+
+    TraceRecorder(const TraceRecorder&) = delete;
+    TraceRecorder& operator=(const TraceRecorder&) = delete;
+
+    /**
+     * @brief Make this the recorder spans are added to
+     */
+    void start();
+
+    /**
+     * @brief Stop recording; spans that end afterwards are discarded
+     */
+    void stop();
+
+    /**
+     * @brief The recorder spans go to, or null while tracing is off
+     */
+    static TraceRecorder* active() { return current.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Whether per-rule spans are wanted by the active recorder
+     */
+    static bool tracing_rules() {
+        TraceRecorder* recorder = active();
+        return recorder && recorder->record_rules;
+    }
+
+    /**
+     * @brief Label the calling thread's track (no-op while tracing is off)
+     * @param name Track name, such as "reader 2"
+     */
+    static void name_thread(std::string_view name);
+
+    /**
+     * @brief Nanoseconds since the recorder was created
+     */
+    uint64_t now() const;
+
+    /**
+     * @brief Append a finished span to the calling thread's ring
+     * @param category Static category string, such as "io"
+     * @param name Span name; truncated to fit the event
+     * @param detail Extra text shown with the span (a path keeps its end when truncated)
+     * @param start_ns Start from now()
+     * @param end_ns End from now()
+     */
+    void record(const char* category, std::string_view name, std::string_view detail, uint64_t start_ns,
+                uint64_t end_ns);
+
+    /**
+     * @brief Write every recorded span as Chrome trace JSON
+     *
+     * Call after recording threads are done, for example after the pipeline finished.
+     *
+     * @param path Output file
+     * @param error Receives a message on failure
+     * @return true if the file was written
+     */
+    bool write(const std::string& path, std::string& error) const;
+
+    /**
+     * @brief Number of spans recorded so far, including dropped ones
+     */
+    uint64_t recorded() const;
+
+    /**
+     * @brief Number of spans overwritten because a ring was full
+     */
+    uint64_t dropped() const;
+
+private:
+    struct Event {
+        uint64_t start;
+        uint64_t duration;
+        const char* category;
+        char name[48];
+        char detail[64];
+    };
+
+    // events are allocated this many at a time, up to events_per_thread
+    static constexpr size_t chunk_events = 1024;
+
+    struct ThreadRing {
+        uint32_t tid = 0;
+        char thread_name[32] = {};
+        std::vector<std::unique_ptr<Event[]>> chunks;   // empty until the thread records a span
+        uint64_t written = 0;   // total appended; the ring holds the last events_per_thread
+    };
+
+    static std::atomic<TraceRecorder*> current;
+
+    const bool record_rules;
+    const size_t events_per_thread;
+    const uint64_t generation;     // tells a thread's cached ring apart from an older recorder's
+    const int64_t origin_ns;
+    mutable std::mutex rings_mutex;
+    std::vector<std::unique_ptr<ThreadRing>> rings;
+
+    ThreadRing& ring();
+    const Event& event_at(const ThreadRing& ring, uint64_t index) const;
+};
+
+/**
+ * @brief Records the lifetime of a scope as one span of the active recorder.
+ *
+ * name and detail are only borrowed, so they must outlive the span. Nothing is recorded
+ * when no recorder is active at construction.
+ */
+class TraceSpan {
+public:
+    TraceSpan(const char* category_, std::string_view name_, std::string_view detail_ = {})
+        : recorder(TraceRecorder::active()), category(category_), name(name_), detail(detail_),
+          start(recorder ? recorder->now() : 0) {}
+
+    ~TraceSpan() {
+        if (recorder && TraceRecorder::active() == recorder) {
+            recorder->record(category, name, detail, start, recorder->now());
+        }
+    }
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+    TraceRecorder* recorder;
+    const char* category;
+    std::string_view name;
+    std::string_view detail;
+    uint64_t start;
+};
+
+#endif // TRACE_H
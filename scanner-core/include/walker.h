@@ -0,0 +1,63 @@
+#ifndef WALKER_H
+#define WALKER_H
+
+#include <string>
+#include <vector>
+#include <unordered_set>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <cstddef>
+#include "pathfilter.h"
+
+/**
+ * @brief Parallel directory walker that prunes ignored directories before descending.
+ *
+ * Directories are read with getdents64/openat on Linux (readdir elsewhere) and the
+ * entry type is taken from d_type, so no stat call is made for the common case.
+ * Discovered files are handed to the callback as soon as they are found.
+ */
+class DirectoryWalker {
+public:
+    using FileCallback = std::function<void(const std::string&)>;
+
+    /**
+     * @brief Constructor for DirectoryWalker
+     * @param filter_ Path filter whose excluded directories are never descended into
+     * @param threads Number of walker threads (0 picks available_cpus())
+     */
+    DirectoryWalker(const PathFilter& filter_, size_t threads = 0);
+
+    /**
+     * @brief Constructor for DirectoryWalker
+     * @param ignored_dirs Set of directory names that are never descended into
+     * @param threads Number of walker threads (0 picks available_cpus())
+     */
+    DirectoryWalker(const std::unordered_set<std::string>& ignored_dirs, size_t threads = 0);
+
+    /**
+     * @brief Walk a directory tree and report every regular file
+     * @param root Directory to start from
+     * @param on_file Called for each regular file; may be invoked concurrently from several threads
+     * @return Number of directories that could not be opened
+     */
+    size_t walk(const std::string& root, const FileCallback& on_file);
+
+private:
+    PathFilter filter;
+    size_t thread_count;
+    size_t root_prefix_len = 0;
+
+    std::vector<std::string> pending;
+    size_t active = 0;
+    std::mutex pending_mutex;
+    std::condition_variable pending_cv;
+    std::atomic<size_t> errors{0};
+
+    void worker(const FileCallback& on_file);
+    void read_directory(const std::string& dir, const FileCallback& on_file,
+                        std::vector<std::string>& subdirs);
+};
+
+#endif // WALKER_H
@@ -0,0 +1,83 @@
+#ifndef WATCHER_H
+#define WATCHER_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <chrono>
+#include <cstddef>
+#include "pathfilter.h"
+
+/**
+ * @brief One coalesced burst of file system changes.
+ */
+struct WatchBatch {
+    std::vector<std::string> changed;   ///< files written, created or moved in
+    std::vector<std::string> removed;   ///< files or whole directories deleted or moved out
+    bool overflow = false;              ///< the kernel dropped events; everything must be rescanned
+
+    bool empty() const { return changed.empty() && removed.empty() && !overflow; }
+};
+
+/**
+ * @brief Recursive directory watcher built on inotify.
+ *
+ * Every directory under the root gets a watch, except the ones the PathFilter excludes,
+ * and directories created later are watched as soon as they appear. Events are collected
+ * until the tree has been quiet for a short time, so a branch checkout that touches
+ * thousands of files arrives as one batch. Waiting blocks in poll, so an idle watcher
+ * uses no CPU. Only Linux is supported; start() fails elsewhere.
+ */
+class DirectoryWatcher {
+public:
+    /**
+     * @brief Constructor for DirectoryWatcher
+     * @param filter_ Path filter whose excluded directories are never watched
+     */
+    explicit DirectoryWatcher(const PathFilter& filter_);
+    ~DirectoryWatcher();
+
+    DirectoryWatcher(const DirectoryWatcher&) = delete;
+    DirectoryWatcher& operator=(const DirectoryWatcher&) = delete;
+
+    /**
+     * @brief Watch every directory under root
+     * @param root Directory to watch
+     * @param error Receives a description when watching is not possible
+     * @return true on success
+     */
+    bool start(const std::string& root, std::string& error);
+
+    /**
+     * @brief Block until files change, then collect events until the tree is quiet
+     * @param batch Receives the changed and removed paths, each listed once
+     * @param quiet Time without events that ends a burst
+     * @param max_delay Longest time a burst is collected before it is returned anyway
+     * @return false once stop() was called or the watch failed
+     */
+    bool next_batch(WatchBatch& batch, std::chrono::milliseconds quiet, std::chrono::milliseconds max_delay);
+
+    /**
+     * @brief Make a blocked or later next_batch return false (safe from any thread)
+     */
+    void stop();
+
+    size_t watch_count() const { return dirs.size(); }
+
+private:
+    PathFilter filter;
+    std::string root_dir;
+    size_t root_prefix_len = 0;
+    int inotify_fd = -1;
+    int wake_pipe[2] = {-1, -1};
+    std::unordered_map<int, std::string> dirs;   // watch descriptor -> directory path
+
+    enum class Change { modified, removed };
+    std::unordered_map<std::string, Change> pending;
+
+    void add_tree(const std::string& dir, bool report_files);
+    void forget_tree(const std::string& dir);
+    bool read_events();
+};
+
+#endif // WATCHER_H
@@ -0,0 +1,355 @@
+/**
+ * @file aggregate.cpp
+ * @brief Bounded-memory collection, grouping and ordering of findings.
+ *
+ * Generic rules can match millions of times in data-heavy repositories. Holding every
+ * finding until the end of the scan grows memory without limit, so findings are collected
+ * into sorted runs that spill to disk, in the manner of an external merge sort, and the
+ * runs are merged while the report is written.
+ *
+ * Features:
+ * - Sorted runs spilled to the temporary directory once a memory limit is reached.
+ * - Heap merge of any number of runs with the findings still in memory.
+ * - Location order for per-finding reports, secret order for grouped ones.
+ * - Groups of one rule and normalized secret with a capped list of locations.
+ * - Compact binary run format; runs are removed when the aggregator is cleared.
+ * - Runs hold plaintext secrets, so they live in a private directory and are created
+ *   owner-only, never through an existing file or link.
+ *
+ * @author Dorna Raj Gyawali <dronarajgyawali@gmail.com>
+ * @date 2025
+ */
+
+#include "aggregate.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <queue>
+#include <sstream>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+std::string_view trim(std::string_view text) {
+    while (!text.empty() && is_space(text.front())) text.remove_prefix(1);
+    while (!text.empty() && is_space(text.back())) text.remove_suffix(1);
+    return text;
+}
+
+uint64_t estimated_bytes(const FindingRecord& finding) {
+    return sizeof(FindingRecord) + finding.file.size() + finding.type.size() + finding.match.size();
+}
+
+// buffered writes to a run opened with open(2), which ofstream cannot do with O_EXCL and a mode
+class RunWriter {
+public:
+    explicit RunWriter(int fd_) : fd(fd_) { buffer.reserve(capacity); }
+
+    void write(const char* data, size_t size) {
+        if (buffer.size() + size > capacity) flush();
+        if (size >= capacity) {
+            write_all(data, size);
+        } else {
+            buffer.insert(buffer.end(), data, data + size);
+        }
+    }
+
+    // false if any write failed
+    bool close() {
+        flush();
+        if (::close(fd) != 0) ok = false;
+        return ok;
+    }
+
+private:
+    static constexpr size_t capacity = 64 * 1024;
+    int fd;
+    bool ok = true;
+    std::vector<char> buffer;
+
+    void flush() {
+        write_all(buffer.data(), buffer.size());
+        buffer.clear();
+    }
+
+    void write_all(const char* data, size_t size) {
+        while (ok && size > 0) {
+            ssize_t written = ::write(fd, data, size);
+            if (written < 0 && errno == EINTR) continue;
+            if (written <= 0) {
+                ok = false;
+                break;
+            }
+            data += written;
+            size -= static_cast<size_t>(written);
+        }
+    }
+};
+
+// run records: length-prefixed strings and fixed-size integers in host byte order; runs
+// never outlive the process that wrote them
+void write_string(RunWriter& out, const std::string& text) {
+    const auto size = static_cast<uint32_t>(text.size());
+    out.write(reinterpret_cast<const char*>(&size), sizeof(size));
+    out.write(text.data(), text.size());
+}
+
+bool read_string(std::ifstream& in, std::string& text) {
+    uint32_t size = 0;
+    if (!in.read(reinterpret_cast<char*>(&size), sizeof(size))) return false;
+    text.resize(size);
+    return size == 0 || static_cast<bool>(in.read(&text[0], size));
+}
+
+template <typename T>
+void write_value(RunWriter& out, T value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template <typename T>
+bool read_value(std::ifstream& in, T& value) {
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(value)));
+}
+
+std::string default_spill_dir() {
+    std::error_code ec;
+    fs::path dir = fs::temp_directory_path(ec);
+    return ec ? std::string("/tmp") : dir.string();
+}
+
+} // namespace
+
+std::string normalize_secret(std::string_view match) {
+    std::string_view text = trim(match);
+    while (text.size() >= 2 && text.front() == text.back() &&
+           (text.front() == '"' || text.front() == '\'' || text.front() == '`')) {
+        text = trim(text.substr(1, text.size() - 2));
+    }
+    std::string normalized;
+    normalized.reserve(text.size());
+    for (size_t i = 0; i < text.size(); ++i) {
+        if (text[i] == '\r' && i + 1 < text.size() && text[i + 1] == '\n') continue;
+        normalized += text[i];
+    }
+    return normalized;
+}
+
+std::string group_to_json(const FindingGroup& group) {
+    std::ostringstream ss;
+    ss << "{"
+       << R"("type":")" << json_escape(group.type) << "\","
+       << R"("secret":")" << json_escape(group.secret) << "\","
+       << R"("count":)" << group.count << ","
+       << R"("files":)" << group.files << ","
+       << R"("locations":[)";
+    for (size_t i = 0; i < group.locations.size(); ++i) {
+        const FindingRecord& location = group.locations[i];
+        ss << (i ? "," : "") << "{"
+           << R"("file":")" << json_escape(location.file) << "\","
+           << R"("line":)" << location.line << ","
+           << R"("column":)" << location.column << ","
+           << R"("offset":)" << location.offset << "}";
+    }
+    ss << "]}";
+    return ss.str();
+}
+
+struct FindingAggregator::RunReader {
+    std::ifstream in;
+    FindingRecord current;
+    bool failed = false;
+
+    // false at the end of the run, or with failed set when the run is cut short
+    bool next() {
+        if (in.peek() == std::ifstream::traits_type::eof()) return false;
+        int32_t line = 0, column = 0;
+        uint64_t offset = 0;
+        if (!read_string(in, current.file) || !read_value(in, line) || !read_value(in, column) ||
+            !read_value(in, offset) || !read_string(in, current.type) || !read_string(in, current.match)) {
+            failed = true;
+            return false;
+        }
+        current.line = line;
+        current.column = column;
+        current.offset = static_cast<size_t>(offset);
+        return true;
+    }
+};
+
+FindingAggregator::FindingAggregator(FindingOrder order_, uint64_t memory_limit_, std::string spill_dir_)
+    : sort_order(order_),
+      memory_limit(memory_limit_),
+      spill_dir(spill_dir_.empty() ? default_spill_dir() : std::move(spill_dir_))
+    {}
+
+FindingAggregator::~FindingAggregator() {
+    clear();
+}
+
+bool FindingAggregator::less(const FindingRecord& a, const FindingRecord& b) const {
+    if (sort_order == FindingOrder::secret) {
+        int by_type = a.type.compare(b.type);
+        if (by_type != 0) return by_type < 0;
+        int by_secret = a.match.compare(b.match);
+        if (by_secret != 0) return by_secret < 0;
+    }
+    return finding_less(a, b);
+}
+
+void FindingAggregator::sort_held() {
+    std::sort(held.begin(), held.end(), [this](const FindingRecord& a, const FindingRecord& b) { return less(a, b); });
+}
+
+void FindingAggregator::add(FindingRecord finding) {
+    if (sort_order == FindingOrder::secret) finding.match = normalize_secret(finding.match);
+    held_bytes += estimated_bytes(finding);
+    held.push_back(std::move(finding));
+    ++total;
+    if (memory_limit && held_bytes > memory_limit && spill_failure.empty()) spill();
+}
+
+void FindingAggregator::spill() {
+    if (run_dir.empty()) {
+        // mkdtemp creates the directory 0700 under a name nobody can claim in advance
+        std::string pattern = (fs::path(spill_dir) / "secret_scanner_spill_XXXXXX").string();
+        if (!mkdtemp(&pattern[0])) {
+            spill_failure = "cannot create a spill directory in " + spill_dir + ": " + std::strerror(errno) +
+                            "; keeping findings in memory";
+            return;
+        }
+        run_dir = pattern;
+    }
+
+    sort_held();
+    const std::string path = (fs::path(run_dir) / ("run_" + std::to_string(runs.size()) + ".run")).string();
+    int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_NOFOLLOW | O_CLOEXEC, 0600);
+    if (fd < 0) {
+        spill_failure = "cannot create " + path + ": " + std::strerror(errno) + "; keeping findings in memory";
+        return;
+    }
+    RunWriter out(fd);
+    for (const FindingRecord& finding : held) {
+        write_string(out, finding.file);
+        write_value(out, static_cast<int32_t>(finding.line));
+        write_value(out, static_cast<int32_t>(finding.column));
+        write_value(out, static_cast<uint64_t>(finding.offset));
+        write_string(out, finding.type);
+        write_string(out, finding.match);
+    }
+    if (!out.close()) {
+        std::error_code ec;
+        fs::remove(path, ec);
+        spill_failure = "cannot write findings to " + path + "; keeping them in memory";
+        return;
+    }
+    runs.push_back(path);
+    held.clear();
+    held.shrink_to_fit();
+    held_bytes = 0;
+}
+
+bool FindingAggregator::for_each(const std::function<void(const FindingRecord&)>& visit, std::string& error) {
+    sort_held();
+    if (runs.empty()) {
+        for (const FindingRecord& finding : held) visit(finding);
+        return true;
+    }
+
+    std::vector<std::unique_ptr<RunReader>> readers;
+    for (const std::string& path : runs) {
+        auto reader = std::make_unique<RunReader>();
+        reader->in.open(path, std::ios::binary);
+        if (!reader->in) {
+            error = "cannot read spilled findings from " + path;
+            return false;
+        }
+        readers.push_back(std::move(reader));
+    }
+
+    // sources are the runs by index, then the findings still in memory
+    const size_t held_source = readers.size();
+    size_t held_pos = 0;
+    auto current = [&](size_t source) -> const FindingRecord& {
+        return source < held_source ? readers[source]->current : held[held_pos];
+    };
+    auto greater = [&](size_t a, size_t b) { return less(current(b), current(a)); };
+    std::priority_queue<size_t, std::vector<size_t>, decltype(greater)> heap(greater);
+    auto advance = [&](size_t source) {
+        if (source == held_source) {
+            if (++held_pos < held.size()) heap.push(source);
+            return true;
+        }
+        if (readers[source]->next()) heap.push(source);
+        return !readers[source]->failed;
+    };
+
+    for (size_t source = 0; source < held_source; ++source) {
+        if (!advance(source)) {
+            error = "spilled findings in " + runs[source] + " are truncated";
+            return false;
+        }
+    }
+    if (!held.empty()) heap.push(held_source);
+    while (!heap.empty()) {
+        const size_t source = heap.top();
+        heap.pop();
+        visit(current(source));
+        if (!advance(source)) {
+            error = "spilled findings in " + runs[source] + " are truncated";
+            return false;
+        }
+    }
+    return true;
+}
+
+bool FindingAggregator::for_each_group(size_t max_locations, const std::function<void(const FindingGroup&)>& visit,
+                                       std::string& error) {
+    FindingGroup group;
+    std::string last_file;
+    bool open = false;
+    bool ok = for_each([&](const FindingRecord& finding) {
+        if (!open || finding.type != group.type || finding.match != group.secret) {
+            if (open) visit(group);
+            group = FindingGroup{};
+            group.type = finding.type;
+            group.secret = finding.match;
+            open = true;
+        }
+        // locations of a group are in file order, so a new file shows up as a change
+        if (group.count == 0 || finding.file != last_file) {
+            ++group.files;
+            last_file = finding.file;
+        }
+        ++group.count;
+        if (max_locations == 0 || group.locations.size() < max_locations) group.locations.push_back(finding);
+    }, error);
+    if (open) visit(group);
+    return ok;
+}
+
+void FindingAggregator::clear() {
+    for (const std::string& path : runs) {
+        std::error_code ec;
+        fs::remove(path, ec);
+    }
+    runs.clear();
+    if (!run_dir.empty()) {
+        std::error_code ec;
+        fs::remove(run_dir, ec);
+        run_dir.clear();
+    }
+    held.clear();
+    held.shrink_to_fit();
+    held_bytes = 0;
+    total = 0;
+}
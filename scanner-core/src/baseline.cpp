@@ -0,0 +1,201 @@
+/**
+ * @file baseline.cpp
+ * @brief Implements finding fingerprints and the memory-mapped Baseline table.
+ *
+ * A baseline records findings that have been reviewed and accepted so that later scans only
+ * report new ones. Each finding is reduced to a 64-bit fingerprint of its rule, its normalized
+ * match and its path relative to the scan root, which stays stable across checkouts and
+ * unrelated edits that only move the secret to another line.
+ *
+ * File layout (native byte order):
+ * - 8 bytes  magic "SSBASE01"
+ * - 8 bytes  table capacity (power of two)
+ * - 8 bytes  number of fingerprints
+ * - capacity x 8 bytes  open-addressing table, 0 = empty slot
+ *
+ * @author Dorna Raj Gyawali <dronarajgyawali@gmail.com>
+ * @date 2025
+ */
+
+#include "baseline.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <cstdio>
+#include <fstream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace {
+
+const char MAGIC[8] = {'S', 'S', 'B', 'A', 'S', 'E', '0', '1'};
+const size_t HEADER_SIZE = 24;
+
+struct Fnv1a {
+    uint64_t hash = 14695981039346656037ULL;
+
+    void add(char c) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ULL;
+    }
+
+    void add(std::string_view s) {
+        for (char c : s) add(c);
+    }
+};
+
+bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\f' || c == '\v';
+}
+
+// spreads fingerprints that differ only in high bits across the table
+uint64_t slot_hash(uint64_t fingerprint) {
+    fingerprint ^= fingerprint >> 33;
+    fingerprint *= 0xff51afd7ed558ccdULL;
+    fingerprint ^= fingerprint >> 33;
+    return fingerprint;
+}
+
+} // namespace
+
+uint64_t finding_fingerprint(std::string_view rule_name, std::string_view match_str, std::string_view rel_path) {
+    Fnv1a h;
+    h.add(rule_name);
+    h.add('\0');
+
+    size_t begin = 0, end = match_str.size();
+    while (begin < end && is_space(match_str[begin])) ++begin;
+    while (end > begin && is_space(match_str[end - 1])) --end;
+    bool in_space = false;
+    for (size_t i = begin; i < end; ++i) {
+        if (is_space(match_str[i])) {
+            in_space = true;
+            continue;
+        }
+        if (in_space) h.add(' ');
+        in_space = false;
+        h.add(match_str[i]);
+    }
+    h.add('\0');
+
+    while (rel_path.size() > 1 && rel_path.compare(0, 2, "./") == 0) rel_path.remove_prefix(2);
+    h.add(rel_path);
+
+    return h.hash ? h.hash : 1;
+}
+
+Baseline::~Baseline() {
+    unmap();
+}
+
+void Baseline::unmap() {
+    if (mapping) {
+        munmap(mapping, mapping_size);
+    }
+    mapping = nullptr;
+    mapping_size = 0;
+    slots = nullptr;
+    capacity = 0;
+    count = 0;
+}
+
+bool Baseline::load(const std::string& file_path, std::string& error) {
+    unmap();
+
+    int fd = open(file_path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        error = "cannot open baseline '" + file_path + "': " + std::strerror(errno);
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < HEADER_SIZE) {
+        close(fd);
+        error = "baseline '" + file_path + "' is truncated";
+        return false;
+    }
+
+    size_t size = static_cast<size_t>(st.st_size);
+    void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        error = "cannot map baseline '" + file_path + "': " + std::strerror(errno);
+        return false;
+    }
+
+    const char* bytes = static_cast<const char*>(data);
+    uint64_t header[2];
+    std::memcpy(header, bytes + 8, sizeof(header));
+    bool valid = std::memcmp(bytes, MAGIC, sizeof(MAGIC)) == 0 &&
+                 header[0] != 0 && (header[0] & (header[0] - 1)) == 0 &&
+                 header[0] <= (size - HEADER_SIZE) / sizeof(uint64_t) &&
+                 size == HEADER_SIZE + header[0] * sizeof(uint64_t) &&
+                 header[1] < header[0];
+    if (!valid) {
+        munmap(data, size);
+        error = "'" + file_path + "' is not a valid baseline file";
+        return false;
+    }
+
+    mapping = data;
+    mapping_size = size;
+    capacity = header[0];
+    count = header[1];
+    slots = reinterpret_cast<const uint64_t*>(bytes + HEADER_SIZE);
+    return true;
+}
+
+bool Baseline::contains(uint64_t fingerprint) const {
+    if (!slots || fingerprint == 0) return false;
+    const uint64_t mask = capacity - 1;
+    uint64_t i = slot_hash(fingerprint) & mask;
+    for (uint64_t probes = 0; probes < capacity; ++probes, i = (i + 1) & mask) {
+        uint64_t slot = slots[i];
+        if (slot == fingerprint) return true;
+        if (slot == 0) return false;
+    }
+    return false;
+}
+
+bool Baseline::write(const std::string& file_path, std::vector<uint64_t> fingerprints, std::string& error) {
+    std::sort(fingerprints.begin(), fingerprints.end());
+    fingerprints.erase(std::unique(fingerprints.begin(), fingerprints.end()), fingerprints.end());
+    fingerprints.erase(std::remove(fingerprints.begin(), fingerprints.end(), 0ULL), fingerprints.end());
+
+    // keep the load factor at or below 50% so probes stay short
+    uint64_t table_capacity = 16;
+    while (table_capacity < fingerprints.size() * 2) table_capacity <<= 1;
+
+    std::vector<uint64_t> table(table_capacity, 0);
+    const uint64_t mask = table_capacity - 1;
+    for (uint64_t fp : fingerprints) {
+        uint64_t i = slot_hash(fp) & mask;
+        while (table[i] != 0) i = (i + 1) & mask;
+        table[i] = fp;
+    }
+
+    std::string tmp_path = file_path + ".tmp";
+    {
+        std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) {
+            error = "cannot write baseline '" + tmp_path + "'";
+            return false;
+        }
+        uint64_t header[2] = {table_capacity, static_cast<uint64_t>(fingerprints.size())};
+        out.write(MAGIC, sizeof(MAGIC));
+        out.write(reinterpret_cast<const char*>(header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(table.data()),
+                  static_cast<std::streamsize>(table.size() * sizeof(uint64_t)));
+        if (!out.good()) {
+            error = "failed while writing baseline '" + tmp_path + "'";
+            return false;
+        }
+    }
+    if (std::rename(tmp_path.c_str(), file_path.c_str()) != 0) {
+        error = "cannot replace baseline '" + file_path + "': " + std::strerror(errno);
+        std::remove(tmp_path.c_str());
+        return false;
+    }
+    return true;
+}
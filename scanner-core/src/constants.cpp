@@ -28,4 +28,10 @@ const std::unordered_set<std::string> ignored_dirs = {
     "tmp", "temp", "cache", ".DS_Store", "ruff_cache", "migrations","migration",
     ".gradle", ".settings", ".classpath", ".project", "bin", "gen", 
     ".metadata", ".nb-gradle", ".nbproject", ".toml", ".lock"
-};
\ No newline at end of file
+};
+
+const std::vector<std::string> default_include_globs = {
+    "Dockerfile", "Containerfile", ".env", ".env.*", "*.env", ".npmrc", ".pypirc", ".netrc"
+};
+
+const std::string ignore_file_name = ".secretscannerignore";
@@ -0,0 +1,74 @@
+/**
+ * @file controller.cpp
+ * @brief Implements the adaptive concurrency controller for the scan pipeline.
+ *
+ * The controller only sees per-interval aggregates, so it stays cheap and can be unit
+ * tested with synthetic samples. Every decision moves a count by one worker at a time.
+ *
+ * Features:
+ * - Utilization-driven matcher count bounded by the CPU count.
+ * - Hill-climbing reader count that keeps a reader only if it raised throughput.
+ * - Cooldown after a rejected probe so stable storage is not probed constantly.
+ *
+ * @author Dorna Raj Gyawali <dronarajgyawali@gmail.com>
+ * @date 2025
+ */
+
+#include "controller.h"
+#include <algorithm>
+
+namespace {
+
+constexpr double PROBE_GAIN = 1.05;      // a probe must improve throughput by 5% to stay
+constexpr size_t PROBE_COOLDOWN = 8;     // intervals to wait after a rejected probe
+constexpr double BUSY = 0.85;
+constexpr double IDLE = 0.5;
+
+// one file open costs about as much as transferring 64 KiB
+double read_throughput(const StageSample& s) {
+    return s.seconds > 0 ? (static_cast<double>(s.files_read) + static_cast<double>(s.bytes_read) / 65536.0) / s.seconds
+                         : 0.0;
+}
+
+} // namespace
+
+ConcurrencyController::ConcurrencyController(const ConcurrencyLimits& limits_, size_t readers_, size_t matchers_)
+    : limits(limits_),
+      reader_count(std::clamp(readers_, limits_.min_readers, std::max(limits_.min_readers, limits_.max_readers))),
+      matcher_count(std::clamp(matchers_, limits_.min_matchers, std::max(limits_.min_matchers, limits_.max_matchers))) {}
+
+void ConcurrencyController::update(const StageSample& s) {
+    if (s.seconds <= 0) return;
+    const double throughput = read_throughput(s);
+    const double match_util = s.match_busy / (s.seconds * static_cast<double>(matcher_count));
+    const double read_util = s.read_busy / (s.seconds * static_cast<double>(reader_count));
+    const bool buffers_backlogged = s.buffer_depth * 2 >= s.buffer_capacity;
+    const bool matchers_starved = s.buffer_depth == 0 && match_util < BUSY;
+
+    // matchers: follow CPU demand
+    if (buffers_backlogged && match_util > BUSY && matcher_count < limits.max_matchers) {
+        ++matcher_count;
+    } else if (match_util < IDLE && s.buffer_depth == 0 && matcher_count > limits.min_matchers) {
+        --matcher_count;
+    }
+
+    // readers: judge the previous probe first
+    if (probing) {
+        probing = false;
+        if (throughput < probe_baseline * PROBE_GAIN && reader_count > limits.min_readers) {
+            --reader_count;
+            cooldown = PROBE_COOLDOWN;
+        }
+        return;
+    }
+    if (cooldown > 0) --cooldown;
+
+    if (buffers_backlogged && read_util < IDLE && reader_count > limits.min_readers) {
+        // matching is the limit; idle readers only add I/O contention
+        --reader_count;
+    } else if (matchers_starved && s.path_depth > 0 && cooldown == 0 && reader_count < limits.max_readers) {
+        ++reader_count;
+        probing = true;
+        probe_baseline = throughput;
+    }
+}
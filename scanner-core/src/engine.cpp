@@ -0,0 +1,200 @@
+/**
+ * @file engine.cpp
+ * @brief Implements the regular expression engines the scanner can match rules with.
+ *
+ * Every engine compiles the rule sources once when it is built and answers "leftmost match
+ * of this pattern in this range" for the scanner's matcher. The libraries other than
+ * std::regex are optional: they are compiled in when CMake finds them and are otherwise
+ * simply absent from available_engines().
+ *
+ * Features:
+ * - std: the rule set's std::regex objects, no extra compilation (default).
+ * - re2: RE2 in Latin-1 mode, so arbitrary bytes match one-to-one (SCANNER_HAVE_RE2).
+ * - pcre2: PCRE2 with JIT compilation where the platform supports it (SCANNER_HAVE_PCRE2).
+ * - Per-rule fallback to std::regex for patterns a library rejects.
+ *
+ * @author Dorna Raj Gyawali <dronarajgyawali@gmail.com>
+ * @date 2025
+ */
+
+#include "engine.h"
+#include <regex>
+
+#ifdef SCANNER_HAVE_RE2
+#include <re2/re2.h>
+#endif
+
+#ifdef SCANNER_HAVE_PCRE2
+#define PCRE2_CODE_UNIT_WIDTH 8
+#include <pcre2.h>
+#endif
+
+namespace {
+
+bool std_search(const Rule& rule, MatchEngine::Part part, std::string_view text, size_t from, size_t to,
+                bool anchored, MatchEngine::Match& match) {
+    // one match object per thread, so repeated searches do not reallocate its storage
+    thread_local std::cmatch found;
+    const std::regex& regex = part == MatchEngine::Part::opening ? rule.regex : rule.end;
+    auto flags = from > 0 ? std::regex_constants::match_prev_avail : std::regex_constants::match_default;
+    if (anchored) flags |= std::regex_constants::match_continuous;
+    if (!std::regex_search(text.data() + from, text.data() + to, found, regex, flags)) return false;
+    match.offset = static_cast<size_t>(found[0].first - text.data());
+    match.length = static_cast<size_t>(found.length(0));
+    return true;
+}
+
+class StdEngine : public MatchEngine {
+public:
+    explicit StdEngine(std::shared_ptr<const RuleSet> rules_) : MatchEngine(std::move(rules_)) {}
+
+    const char* name() const override { return "std"; }
+
+    bool search(uint32_t rule, Part part, std::string_view text, size_t from, size_t to, bool anchored,
+                Match& match) const override {
+        return std_search(rules->rules()[rule], part, text, from, to, anchored, match);
+    }
+
+    size_t native_rules() const override { return rules->size(); }
+};
+
+#ifdef SCANNER_HAVE_RE2
+class Re2Engine : public MatchEngine {
+public:
+    explicit Re2Engine(std::shared_ptr<const RuleSet> rules_) : MatchEngine(std::move(rules_)) {
+        for (const Rule& rule : rules->rules()) {
+            Compiled compiled{compile(rule.pattern, rule.icase), compile(rule.end_pattern, rule.icase)};
+            if (compiled.opening && (!rule.spans_lines || compiled.closing)) ++native;
+            patterns.push_back(std::move(compiled));
+        }
+    }
+
+    const char* name() const override { return "re2"; }
+
+    bool search(uint32_t rule, Part part, std::string_view text, size_t from, size_t to, bool anchored,
+                Match& match) const override {
+        const RE2* regex = part == Part::opening ? patterns[rule].opening.get() : patterns[rule].closing.get();
+        if (!regex) return std_search(rules->rules()[rule], part, text, from, to, anchored, match);
+
+        // the text before from stays visible, so \b and friends see the same context as std::regex
+        re2::StringPiece found;
+        if (!regex->Match(re2::StringPiece(text.data(), to), from, to,
+                          anchored ? RE2::ANCHOR_START : RE2::UNANCHORED, &found, 1)) {
+            return false;
+        }
+        match.offset = static_cast<size_t>(found.data() - text.data());
+        match.length = found.size();
+        return true;
+    }
+
+    size_t native_rules() const override { return native; }
+
+private:
+    struct Compiled {
+        std::unique_ptr<RE2> opening;
+        std::unique_ptr<RE2> closing;
+    };
+    std::vector<Compiled> patterns;
+    size_t native = 0;
+
+    static std::unique_ptr<RE2> compile(const std::string& pattern, bool icase) {
+        if (pattern.empty()) return nullptr;
+        RE2::Options options;
+        options.set_encoding(RE2::Options::EncodingLatin1);
+        options.set_case_sensitive(!icase);
+        options.set_log_errors(false);
+        auto regex = std::make_unique<RE2>(pattern, options);
+        return regex->ok() ? std::move(regex) : nullptr;
+    }
+};
+#endif
+
+#ifdef SCANNER_HAVE_PCRE2
+class Pcre2Engine : public MatchEngine {
+public:
+    explicit Pcre2Engine(std::shared_ptr<const RuleSet> rules_) : MatchEngine(std::move(rules_)) {
+        for (const Rule& rule : rules->rules()) {
+            Compiled compiled;
+            compiled.opening = compile(rule.pattern, rule.icase, 0);
+            compiled.opening_anchored = compile(rule.pattern, rule.icase, PCRE2_ANCHORED);
+            compiled.closing = compile(rule.end_pattern, rule.icase, 0);
+            compiled.closing_anchored = compile(rule.end_pattern, rule.icase, PCRE2_ANCHORED);
+            if (compiled.opening && (!rule.spans_lines || compiled.closing)) ++native;
+            patterns.push_back(std::move(compiled));
+        }
+    }
+
+    const char* name() const override { return "pcre2"; }
+
+    bool search(uint32_t rule, Part part, std::string_view text, size_t from, size_t to, bool anchored,
+                Match& match) const override {
+        const Compiled& compiled = patterns[rule];
+        // anchoring is compiled in, because PCRE2_ANCHORED at match time bypasses the JIT
+        const pcre2_code* code = part == Part::opening
+            ? (anchored ? compiled.opening_anchored : compiled.opening).get()
+            : (anchored ? compiled.closing_anchored : compiled.closing).get();
+        if (!code) return std_search(rules->rules()[rule], part, text, from, to, anchored, match);
+
+        thread_local MatchData data(pcre2_match_data_create(1, nullptr), pcre2_match_data_free);
+        int rc = pcre2_match(code, reinterpret_cast<PCRE2_SPTR>(text.data()), to, from, 0, data.get(), nullptr);
+        // 0 means more groups matched than the single ovector pair holds; group 0 is still set
+        if (rc < 0) return false;
+        const PCRE2_SIZE* ovector = pcre2_get_ovector_pointer(data.get());
+        match.offset = ovector[0];
+        match.length = ovector[1] - ovector[0];
+        return true;
+    }
+
+    size_t native_rules() const override { return native; }
+
+private:
+    using Code = std::unique_ptr<pcre2_code, void (*)(pcre2_code*)>;
+    using MatchData = std::unique_ptr<pcre2_match_data, void (*)(pcre2_match_data*)>;
+
+    struct Compiled {
+        Code opening{nullptr, pcre2_code_free};
+        Code opening_anchored{nullptr, pcre2_code_free};
+        Code closing{nullptr, pcre2_code_free};
+        Code closing_anchored{nullptr, pcre2_code_free};
+    };
+    std::vector<Compiled> patterns;
+    size_t native = 0;
+
+    static Code compile(const std::string& pattern, bool icase, uint32_t options) {
+        if (pattern.empty()) return Code(nullptr, pcre2_code_free);
+        int error = 0;
+        PCRE2_SIZE error_offset = 0;
+        if (icase) options |= PCRE2_CASELESS;
+        Code code(pcre2_compile(reinterpret_cast<PCRE2_SPTR>(pattern.data()), pattern.size(), options, &error,
+                                &error_offset, nullptr),
+                  pcre2_code_free);
+        // without JIT support pcre2_match runs the interpreter on the same code
+        if (code) pcre2_jit_compile(code.get(), PCRE2_JIT_COMPLETE);
+        return code;
+    }
+};
+#endif
+
+} // namespace
+
+std::vector<std::string> available_engines() {
+    std::vector<std::string> names = {"std"};
+#ifdef SCANNER_HAVE_RE2
+    names.push_back("re2");
+#endif
+#ifdef SCANNER_HAVE_PCRE2
+    names.push_back("pcre2");
+#endif
+    return names;
+}
+
+std::shared_ptr<const MatchEngine> make_engine(const std::string& name, std::shared_ptr<const RuleSet> rules) {
+    if (name == "std") return std::make_shared<StdEngine>(std::move(rules));
+#ifdef SCANNER_HAVE_RE2
+    if (name == "re2") return std::make_shared<Re2Engine>(std::move(rules));
+#endif
+#ifdef SCANNER_HAVE_PCRE2
+    if (name == "pcre2") return std::make_shared<Pcre2Engine>(std::move(rules));
+#endif
+    return nullptr;
+}
@@ -0,0 +1,93 @@
+/**
+ * @file linecounter.cpp
+ * @brief Vectorized newline counting and lazy offset-to-line resolution.
+ *
+ * Findings are rare compared to lines, so the scanner matches over whole buffers and only
+ * resolves line and column numbers for the offsets where something was found. The newline
+ * counter compares 16 bytes at a time (SSE2 on x86, NEON on AArch64) and falls back to a
+ * scalar loop on other targets.
+ *
+ * @author Dorna Raj Gyawali <dronarajgyawali@gmail.com>
+ * @date 2025
+ */
+
+#include "linecounter.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+size_t count_newlines(const char* data, size_t size) {
+    size_t count = 0;
+    size_t i = 0;
+
+#if defined(__SSE2__)
+    const __m128i newline = _mm_set1_epi8('\n');
+    for (; i + 64 <= size; i += 64) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + 16));
+        __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + 32));
+        __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + 48));
+        unsigned long long mask =
+            static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(a, newline))) |
+            static_cast<unsigned long long>(static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(b, newline)))) << 16 |
+            static_cast<unsigned long long>(static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(c, newline)))) << 32 |
+            static_cast<unsigned long long>(static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(d, newline)))) << 48;
+        count += static_cast<size_t>(__builtin_popcountll(mask));
+    }
+    for (; i + 16 <= size; i += 16) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        count += static_cast<size_t>(__builtin_popcount(
+            static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(a, newline)))));
+    }
+#elif defined(__aarch64__)
+    const uint8x16_t newline = vdupq_n_u8('\n');
+    const uint8x16_t one = vdupq_n_u8(1);
+    for (; i + 16 <= size; i += 16) {
+        uint8x16_t a = vld1q_u8(reinterpret_cast<const uint8_t*>(data + i));
+        count += vaddvq_u8(vandq_u8(vceqq_u8(a, newline), one));
+    }
+#endif
+
+    for (; i < size; ++i) {
+        count += data[i] == '\n';
+    }
+    return count;
+}
+
+LineCounter::LineCounter(std::string_view buffer_, size_t first_line)
+    : buffer(buffer_), base_line(first_line) {}
+
+LineCounter::Position LineCounter::locate(size_t offset) {
+    if (offset > buffer.size()) offset = buffer.size();
+    if (offset < counted_to) {
+        // lookups went backwards; start over from the beginning of the buffer
+        counted_to = 0;
+        line = 0;
+        line_start = 0;
+    }
+
+    size_t newlines = count_newlines(buffer.data() + counted_to, offset - counted_to);
+    if (newlines > 0) {
+        line += newlines;
+        size_t pos = offset;
+        while (pos > counted_to && buffer[pos - 1] != '\n') --pos;
+        line_start = pos;
+    }
+    counted_to = offset;
+    return Position{base_line + line, offset - line_start + 1};
+}
+
+LineCounter::Position StreamLineCounter::locate(std::string_view window, size_t base, size_t offset) {
+    size_t newlines = count_newlines(window.data() + (counted_to - base), offset - counted_to);
+    if (newlines > 0) {
+        line += newlines;
+        size_t pos = offset;
+        while (pos > counted_to && window[pos - 1 - base] != '\n') --pos;
+        line_start = pos;
+    }
+    counted_to = offset;
+    return LineCounter::Position{line, offset - line_start + 1};
+}
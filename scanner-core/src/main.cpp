@@ -1,7 +1,7 @@
 #include <iostream>
+#include <fstream>
 #include <filesystem>
 #include <vector>
-#include <future>
 #include <unordered_set>
 #include <chrono>
 #include <thread>
@@ -9,10 +9,31 @@
 #include <iomanip>
 #include <sstream>
 #include <algorithm>
-#include "threadpool.h"
+#include <functional>
+#include <map>
+#include <mutex>
+#include <condition_variable>
+#include <cerrno>
+#include <csignal>
+#include <fcntl.h>
+#include <unistd.h>
+#include "pipeline.h"
+#include "walker.h"
+#include "pathfilter.h"
+#include "options.h"
+#include "baseline.h"
+#include "metrics.h"
+#include "report.h"
+#include "shard.h"
+#include "watcher.h"
+#include "priority.h"
+#include "resources.h"
+#include "pathlist.h"
+#include "aggregate.h"
 #include "scanner.h"
 #include "constants.h"
 #include "regexpattern.h"
+#include "trace.h"
 
 namespace fs = std::filesystem;
 
@@ -21,9 +42,29 @@ private:
     std::atomic<int> files_scanned{0};
     std::atomic<int> total_files{0};
     std::atomic<int> secrets_found{0};
+    std::atomic<int> secrets_suppressed{0};
     std::atomic<bool> scanning_complete{false};
-    std::vector<std::string> found_secrets;
+    std::atomic<bool> walk_complete{false};
+    std::atomic<bool> results_emitted{false};
+    // formatted findings, spilled to sorted runs on disk once they outgrow their memory
+    std::unique_ptr<FindingAggregator> found_secrets = std::make_unique<FindingAggregator>();
+    size_t max_locations = 0;
+    // findings as the scanners reported them: ids and offsets into one arena, turned into
+    // FindingRecords in batches or when results are read
+    FindingBuffer pending_findings;
+    static constexpr size_t pending_batch = 4096;
+    std::vector<std::string> pending_files;
+    const RuleSet* pending_rules = nullptr;
+    size_t finding_limit = 0;
+    std::function<void()> on_finding_limit;
+    std::atomic<bool> limit_reached{false};
+    std::vector<std::pair<std::string, std::string>> partial_files;
+    std::vector<uint64_t> fingerprints;
     std::mutex secrets_mutex;
+    // findings held in memory are charged to the scan's memory budget until spilled or handed out
+    MemoryBudget* memory_budget = nullptr;
+    uint64_t pending_bytes = 0;
+    uint64_t result_bytes = 0;
 
     // ANSI color codes
     const std::string RESET = "\033[0m";
@@ -50,12 +91,69 @@ public:
 
     void print_help() {
         std::cout << BOLD << "Usage:\n" << RESET;
-        std::cout << "  " << CYAN << "./scanner" << RESET << " [directory]\n\n";
+        std::cout << "  " << CYAN << "./scanner" << RESET << " [options] [directory]\n";
+        std::cout << "  " << CYAN << "./scanner merge" << RESET << " PARTIAL...   Combine --shard results into one report\n\n";
+        std::cout << BOLD << "Options:\n" << RESET;
+        std::cout << "  --include=GLOB        Also scan files matching GLOB (repeatable)\n";
+        std::cout << "  --exclude=GLOB        Skip files and directories matching GLOB (repeatable)\n";
+        std::cout << "  --baseline=FILE       Only report findings that are not recorded in FILE\n";
+        std::cout << "  --write-baseline=FILE Record every finding of this scan in FILE\n";
+        std::cout << "  --update-baseline     Rewrite the --baseline file from this scan\n";
+        std::cout << "  --max-line-length=N   Search files whose longest line is over 4096 and at most N bytes\n";
+        std::cout << "                        whole with plain regex search instead of the guarded matcher\n";
+        std::cout << "                        (default 4096 = never); the file budget is only checked between\n";
+        std::cout << "                        rules there, so one rule's search over a large file cannot be\n";
+        std::cout << "                        interrupted\n";
+        std::cout << "  --file-budget-ms=N    CPU time allowed per file before it is reported as partially\n";
+        std::cout << "                        scanned (default 10000, 0 = unlimited)\n";
+        std::cout << "  --batch=FILE          Scan every directory listed in FILE (one per line) with one\n";
+        std::cout << "                        shared rule set and worker pool; prints results per directory\n";
+        std::cout << "  --files-from=FILE     Scan the NUL- or newline-separated paths listed in FILE ('-' = stdin)\n";
+        std::cout << "                        instead of walking the directory; relative paths start at the\n";
+        std::cout << "                        directory (default: the working directory)\n";
+        std::cout << "  --apply-filters       With --files-from: still apply the extension, glob, ignore file and\n";
+        std::cout << "                        .gitignore filters to the listed files\n";
+        std::cout << "  --shard=I/N           Scan only shard I (0-based) of N; files are split by size and path hash\n";
+        std::cout << "  --partial-out=FILE    Where --shard writes its mergeable result (default shard-I-of-N.ndjson)\n";
+        std::cout << "  --metrics-file=FILE   Write Prometheus text-format metrics to FILE periodically and at exit\n";
+        std::cout << "  --metrics-interval=N  Seconds between metrics file writes (default 10, 0 = only at exit)\n";
+        std::cout << "  --watch               Scan once, then rescan changed files and print finding deltas\n";
+        std::cout << "  --stream              Scan stdin (or the FIFO given as the directory) as it arrives and\n";
+        std::cout << "                        print each finding when its line is complete\n";
+        std::cout << "  --redact              With --stream: copy the input to stdout with secrets masked;\n";
+        std::cout << "                        findings go to stderr\n";
+        std::cout << "  --readers=N           Use exactly N reader threads (turns off adaptive thread counts)\n";
+        std::cout << "  --matchers=N          Use exactly N matcher threads (turns off adaptive thread counts)\n";
+        std::cout << "  --metrics-json=FILE   Write a JSON metrics summary to FILE at exit\n";
+        std::cout << "  --prioritize          Scan likely secret holders first (.env, keys, config, recent, small)\n";
+        std::cout << "  --max-findings=N      Stop scanning once N findings are reported (implies --prioritize)\n";
+        std::cout << "  --fail-fast           Same as --max-findings=1, for CI gates\n";
+        std::string engines;
+        for (const auto& name : available_engines()) engines += (engines.empty() ? "" : ", ") + name;
+        std::cout << "  --engine=NAME         Regular expression engine: " << engines << " (default std)\n";
+        std::cout << "  --trace=FILE          Write a Chrome trace (Perfetto, chrome://tracing) of walk, read,\n";
+        std::cout << "                        match and report spans per thread and file to FILE\n";
+        std::cout << "  --trace-rules         With --trace: also record a span per rule per file\n";
+        std::cout << "  --decode              Also decode base64 and hex strings and scan the result, two layers deep\n";
+        std::cout << "  --decode-depth=N      Decode up to N nested layers (0 = off)\n";
+        std::cout << "  --memory-budget=SIZE  Bytes file buffers and findings may hold, e.g. 512M or 2G (default\n";
+        std::cout << "                        half the container memory limit, 0 = unlimited)\n";
+        std::cout << "  --group               Report each secret once per rule, with the files and lines it was\n";
+        std::cout << "                        found at, instead of one line per finding\n";
+        std::cout << "  --max-locations=N     With --group: list at most N locations per secret (default 10, 0 = all)\n";
+        std::cout << "  --results-memory=SIZE Findings held in memory before they spill to sorted files in the\n";
+        std::cout << "                        temporary directory (default 64M)\n";
+        std::cout << "  --low-priority        Run at nice 10 with idle I/O priority, yielding to other work\n";
+        std::cout << "  -h, --help            Show this help\n\n";
+        std::cout << "  Patterns from a '.secretscannerignore' file in the scanned directory are\n";
+        std::cout << "  applied as excludes; lines starting with '!' are applied as includes.\n\n";
         std::cout << BOLD << "Examples:\n" << RESET;
         std::cout << "  " << GREEN << "./scanner" << RESET << "                    # Scan current 'src/' directory\n";
         std::cout << "  " << GREEN << "./scanner /path/to/code" << RESET << "    # Scan specific directory\n";
         std::cout << "  " << GREEN << "./scanner ." << RESET << "                 # Scan current directory\n";
-        std::cout << "  " << GREEN << "./scanner ../project" << RESET << "       # Scan relative path\n\n";
+        std::cout << "  " << GREEN << "./scanner ../project" << RESET << "       # Scan relative path\n";
+        std::cout << "  " << GREEN << "./scanner --exclude='**/fixtures/**' ." << RESET << "\n";
+        std::cout << "  " << GREEN << "git ls-files -z | ./scanner --files-from=-" << RESET << "\n\n";
     }
 
     std::string resolve_directory(const std::string& input) {
@@ -112,45 +210,187 @@ public:
         }).detach();
     }
 
-    void count_files(const std::string& root_dir, const std::unordered_set<std::string>& ignored_dirs_set,
-                    const std::unordered_set<std::string>& valid_ext_set, SecretScanner& scanner) {
-        try {
-            for (const auto& entry : fs::recursive_directory_iterator(root_dir)) {
-                if (!entry.is_regular_file()) continue;
-                const auto& path = entry.path();
-                if (scanner.is_ignored_dir(path.parent_path())) continue;
-                if (!scanner.is_valid_extension(path)) continue;
-                if (scanner.is_git_ignored(path.string())) continue;
-                total_files++;
-            }
-        } catch (const fs::filesystem_error&) {
+    // keeps the findings of one file whose keep flag is set (all of them without flags)
+    void add_findings(const std::string& file_path, const RuleSet& rules, const FindingBuffer& findings,
+                      const std::vector<char>* keep) {
+        std::lock_guard<std::mutex> lock(secrets_mutex);
+        const auto file = static_cast<uint32_t>(pending_files.size());
+        int added = 0;
+        uint64_t bytes = 0;
+        for (size_t i = 0; i < findings.size(); ++i) {
+            if (keep && !(*keep)[i]) continue;
+            Finding finding = findings[i];
+            finding.file = file;
+            pending_findings.append(finding, findings.text(findings[i]));
+            // what the finding occupies once formatted into a FindingRecord
+            bytes += sizeof(FindingRecord) + file_path.size() + findings.text(findings[i]).size();
+            ++added;
         }
+        if (added == 0) return;
+        pending_bytes += bytes;
+        pending_files.push_back(file_path);
+        pending_rules = &rules;
+        if (pending_findings.size() >= pending_batch) format_pending();
+        account_results();
+        secrets_found += added;
+        if (finding_limit && static_cast<size_t>(secrets_found.load()) >= finding_limit &&
+            !limit_reached.exchange(true) && on_finding_limit) {
+            on_finding_limit();
+        }
+    }
+
+    void set_memory_budget(MemoryBudget* budget) {
+        memory_budget = budget;
+    }
+
+    // findings come back grouped by rule and secret when order is FindingOrder::secret;
+    // only called before scanning starts
+    void configure_results(FindingOrder order, uint64_t memory_limit, size_t max_locations_) {
+        found_secrets = std::make_unique<FindingAggregator>(order, memory_limit);
+        max_locations = max_locations_;
+    }
+
+    // brings the memory budget's view of held findings up to date; the caller holds secrets_mutex
+    void account_results() {
+        const uint64_t held = pending_bytes + found_secrets->memory_bytes();
+        if (memory_budget && held > result_bytes) memory_budget->charge(held - result_bytes);
+        if (memory_budget && held < result_bytes) memory_budget->discharge(result_bytes - held);
+        result_bytes = held;
+    }
+
+    // every finding in report order; false (after a message) if spilled findings were lost
+    bool visit_findings(const std::function<void(const FindingRecord&)>& visit) {
+        std::string error;
+        if (found_secrets->for_each(visit, error)) return true;
+        print_error(error);
+        return false;
+    }
+
+    // on_limit runs once, on the scanning thread that reports the limit-th finding
+    void set_finding_limit(size_t limit, std::function<void()> on_limit) {
+        finding_limit = limit;
+        on_finding_limit = std::move(on_limit);
     }
 
-    void add_secret_result(const std::string& file_path, int line_number, 
-                          const std::string& pattern_name, const std::string& match_str) {
+    bool finding_limit_reached() const {
+        return limit_reached.load();
+    }
+
+    void add_partial_result(const std::string& file_path, const std::string& reason) {
         std::lock_guard<std::mutex> lock(secrets_mutex);
-        
-        std::stringstream ss;
-        ss << "{"
-           << R"("file":")" << file_path << "\","
-           << R"("line":)" << line_number << ","
-           << R"("type":")" << pattern_name << "\","
-           << R"("match":")" << match_str << "\""
-           << "}";
-        
-        found_secrets.push_back(ss.str());
-        secrets_found++;
+        partial_files.emplace_back(file_path, reason);
+    }
+
+    void add_fingerprint(uint64_t fingerprint) {
+        std::lock_guard<std::mutex> lock(secrets_mutex);
+        fingerprints.push_back(fingerprint);
+    }
+
+    // moves pending findings into found_secrets; the caller holds secrets_mutex
+    void format_pending() {
+        for (const Finding& finding : pending_findings) {
+            found_secrets->add({pending_files[finding.file], static_cast<int>(finding.line),
+                                static_cast<int>(finding.column), finding.offset,
+                                pending_rules->rules()[finding.rule].name,
+                                std::string(pending_findings.text(finding))});
+        }
+        pending_findings.clear();
+        pending_files.clear();
+        pending_bytes = 0;
+    }
+
+    // findings and partial files reported since the last call, for incremental rescans
+    std::vector<FindingRecord> take_findings() {
+        std::lock_guard<std::mutex> lock(secrets_mutex);
+        format_pending();
+        std::vector<FindingRecord> taken;
+        taken.reserve(found_secrets->size());
+        visit_findings([&taken](const FindingRecord& finding) { taken.push_back(finding); });
+        found_secrets->clear();
+        account_results();
+        return taken;
+    }
+
+    std::vector<std::pair<std::string, std::string>> take_partial_files() {
+        std::lock_guard<std::mutex> lock(secrets_mutex);
+        std::vector<std::pair<std::string, std::string>> taken;
+        taken.swap(partial_files);
+        return taken;
+    }
+
+    const std::vector<uint64_t>& get_fingerprints() const {
+        return fingerprints;
+    }
+
+    // findings in report order, read back from memory and spilled runs one at a time; only
+    // valid once scanning has finished
+    bool for_each_finding(const std::function<void(const FindingRecord&)>& visit, std::string& error) {
+        format_pending();
+        return found_secrets->for_each(visit, error);
+    }
+
+    // partial files in report order; only valid once scanning has finished
+
+    const std::vector<std::pair<std::string, std::string>>& sorted_partial_files() {
+        std::sort(partial_files.begin(), partial_files.end());
+        return partial_files;
+    }
+
+    int get_secrets_suppressed() const {
+        return secrets_suppressed.load();
+    }
+
+    // a finding of a shard's partial result, streamed in while the partials are read
+    void add_merged_finding(FindingRecord finding, const std::string& root) {
+        finding.file = merged_path(root, finding.file);
+        found_secrets->add(std::move(finding));
+    }
+
+    // results of a merged sharded scan, reported as if this process had scanned everything;
+    // findings arrive through add_merged_finding
+    void load_merged(const ShardPartial& merged) {
+        files_scanned = static_cast<int>(merged.files_scanned);
+        total_files = static_cast<int>(merged.total_files);
+        secrets_found = static_cast<int>(found_secrets->size());
+        secrets_suppressed = static_cast<int>(merged.secrets_suppressed);
+        partial_files = merged.partial_files;
+        for (auto& entry : partial_files) entry.first = merged_path(merged.root, entry.first);
+    }
+
+    // partial results hold root-relative paths, or absolute ones for files listed from outside the root
+    static std::string merged_path(const std::string& root, const std::string& file) {
+        if (!file.empty() && file[0] == '/') return file;
+        return root.empty() || root.back() == '/' ? root + file : root + "/" + file;
+    }
+
+    void increment_suppressed() {
+        secrets_suppressed++;
     }
 
     void increment_files_scanned() {
         files_scanned++;
     }
 
+    void increment_total_files() {
+        total_files++;
+    }
+
     void set_scanning_complete() {
         scanning_complete = true;
     }
 
+    void set_walk_complete() {
+        walk_complete = true;
+    }
+
+    // true exactly once: after the walk has ended and every file it submitted is done
+    bool try_complete() {
+        if (!walk_complete.load() || files_scanned.load() != total_files.load()) {
+            return false;
+        }
+        return !results_emitted.exchange(true);
+    }
+
     int get_files_scanned() const {
         return files_scanned.load();
     }
@@ -171,15 +411,37 @@ public:
         
         std::cout << BOLD << " Summary:\n" << RESET;
         std::cout << "  • Files scanned: " << GREEN << files_scanned.load() << RESET << "\n";
-        std::cout << "  • Secrets found: " << RED << secrets_found.load() << RESET << "\n\n";
+        std::cout << "  • Secrets found: " << RED << secrets_found.load() << RESET << "\n";
+        if (secrets_suppressed.load() > 0) {
+            std::cout << "  • Known (baseline): " << secrets_suppressed.load() << "\n";
+        }
+        if (!partial_files.empty()) {
+            std::cout << "  • Partially scanned: " << YELLOW << partial_files.size() << RESET << "\n";
+            for (const auto& [file, reason] : sorted_partial_files()) {
+                std::cout << "      " << file << " (" << reason << ")\n";
+            }
+        }
+        std::cout << "\n";
 
         if (secrets_found.load() > 0) {
             std::cout << RED << BOLD << "  SECURITY ISSUES DETECTED:\n" << RESET;
             std::cout << YELLOW << "═══════════════════════════════════════════════════════════════\n" << RESET;
             
-            for (const auto& secret : found_secrets) {
-                std::cout << secret << "\n";
+            format_pending();
+            size_t groups = 0;
+            if (found_secrets->order() == FindingOrder::secret) {
+                std::string error;
+                if (!found_secrets->for_each_group(max_locations, [&groups](const FindingGroup& group) {
+                        std::cout << group_to_json(group) << "\n";
+                        ++groups;
+                    }, error)) {
+                    print_error(error);
+                }
+            } else {
+                visit_findings([](const FindingRecord& secret) { std::cout << finding_to_json(secret) << "\n"; });
             }
+            if (groups) std::cout << "  " << groups << " distinct secrets\n";
+            if (!found_secrets->spill_error().empty()) std::cerr << "warning: " << found_secrets->spill_error() << "\n";
             
             std::cout << YELLOW << "═══════════════════════════════════════════════════════════════\n" << RESET;
             std::cout << RED << BOLD << "\n ACTION REQUIRED: " << RESET 
@@ -192,6 +454,21 @@ public:
         std::cout << "\n" << CYAN << "Scan completed successfully!" << RESET << "\n";
     }
 
+    // one repository of a batch: its findings followed by a summary line
+    void print_repo_results(const std::string& root) {
+        std::lock_guard<std::mutex> lock(secrets_mutex);
+        format_pending();
+        visit_findings([](const FindingRecord& secret) { std::cout << finding_to_json(secret) << "\n"; });
+        std::cout << "{"
+                  << R"("repo":")" << root << "\","
+                  << R"("files_scanned":)" << files_scanned.load() << ","
+                  << R"("secrets_found":)" << secrets_found.load() << ","
+                  << R"("partially_scanned":)" << partial_files.size()
+                  << "}" << std::endl;
+        found_secrets->clear();
+        account_results();
+    }
+
     void print_error(const std::string& message) {
         std::cout << RED << BOLD << " ERROR: " << RESET << message << "\n";
     }
@@ -204,37 +481,844 @@ public:
 class CLISecretScanner : public SecretScanner {
 private:
     CLIInterface* cli_interface;
+    const Baseline* baseline = nullptr;
+    std::string root_dir;
+    size_t root_prefix_len = 0;
+    bool record_fingerprints = false;
+    Counter& findings;
+    Counter& suppressed;
+    Counter& partial;
 
 public:
     CLISecretScanner(const std::unordered_set<std::string>& ignored_dirs,
                     const std::unordered_set<std::string>& valid_extensions,
-                    const std::vector<std::pair<std::string, std::regex>>& patterns,
-                    CLIInterface* cli) 
-        : SecretScanner(ignored_dirs, valid_extensions, patterns), cli_interface(cli) {}
+                    std::shared_ptr<const RuleSet> rules,
+                    CLIInterface* cli,
+                    MetricsRegistry& metrics) 
+        : SecretScanner(ignored_dirs, valid_extensions, std::move(rules)), cli_interface(cli),
+          findings(metrics.counter("scanner_findings_total", "Findings reported")),
+          suppressed(metrics.counter("scanner_findings_suppressed_total", "Findings suppressed by the baseline")),
+          partial(metrics.counter("scanner_files_partial_total", "Files whose scan ran out of CPU budget")) {}
+
+    void set_root(const std::string& root) {
+        root_dir = root;
+        root_prefix_len = root.size() + (!root.empty() && root.back() == '/' ? 0 : 1);
+    }
+
+    const std::string& get_root() const { return root_dir; }
+    size_t get_root_prefix_len() const { return root_prefix_len; }
+
+    // the root-relative form of a path, or the path itself when it lies outside the root
+    std::string_view relative_path(std::string_view path) const {
+        return path.substr(root_relative_offset(path, root_dir));
+    }
+    CLIInterface& get_interface() const { return *cli_interface; }
+
+    void use_baseline(const Baseline* baseline_, bool record_fingerprints_) {
+        baseline = baseline_;
+        record_fingerprints = record_fingerprints_;
+    }
 
-    void scan_file_with_callback(const std::string& file_path) {
-        scan_file(file_path);
-        cli_interface->increment_files_scanned();
+    void report_findings(const std::string& file_path, const FindingBuffer& found) const override {
+        const RuleSet& rules = get_rules();
+        if (!baseline && !record_fingerprints) {
+            findings.add(found.size());
+            cli_interface->add_findings(file_path, rules, found, nullptr);
+            return;
+        }
+
+        // known findings are dropped before any formatting happens
+        thread_local std::vector<char> keep;
+        keep.assign(found.size(), 1);
+        std::string_view rel_path = relative_path(file_path);
+        size_t kept = 0;
+        for (size_t i = 0; i < found.size(); ++i) {
+            uint64_t fingerprint = finding_fingerprint(rules.rules()[found[i].rule].name, found.text(found[i]), rel_path);
+            if (record_fingerprints) cli_interface->add_fingerprint(fingerprint);
+            if (baseline && baseline->contains(fingerprint)) {
+                keep[i] = 0;
+                cli_interface->increment_suppressed();
+                suppressed.add();
+            } else {
+                ++kept;
+            }
+        }
+        findings.add(kept);
+        if (kept > 0) cli_interface->add_findings(file_path, rules, found, &keep);
     }
 
-    void report_secret(const std::string& file_path, int line_number, 
-                      const std::string& pattern_name, const std::string& match_str) const override {
-        cli_interface->add_secret_result(file_path, line_number, pattern_name, match_str);
+    void report_partial_scan(const std::string& file_path, const std::string& reason) const override {
+        partial.add();
+        cli_interface->add_partial_result(file_path, reason);
     }
 };
 
-int main(int argc, char* argv[]) {
-    CLIInterface cli;
+// counters for the walk stage, shared by every scanned root
+struct WalkMetrics {
+    Counter& discovered;
+    Counter& skipped_filter;
+    Counter& skipped_gitignore;
+    Counter& skipped_missing;
+    Counter& gitignore_checks;
+    Counter& errors;
+
+    explicit WalkMetrics(MetricsRegistry& metrics)
+        : discovered(metrics.counter("scanner_files_discovered_total", "Files found by the directory walk")),
+          skipped_filter(metrics.counter("scanner_files_skipped_total", "Discovered files that were not scanned",
+                                         {{"reason", "filter"}})),
+          skipped_gitignore(metrics.counter("scanner_files_skipped_total", "Discovered files that were not scanned",
+                                            {{"reason", "gitignore"}})),
+          skipped_missing(metrics.counter("scanner_files_skipped_total", "Discovered files that were not scanned",
+                                          {{"reason", "missing"}})),
+          gitignore_checks(metrics.counter("scanner_gitignore_checks_total", "Files checked with git check-ignore")),
+          errors(metrics.counter("scanner_walk_errors_total", "Directories that could not be opened")) {}
+};
+
+ScanLimits scan_limits(const ScanOptions& options) {
+    ScanLimits limits;
+    if (options.max_line_length) limits.long_line_length = options.max_line_length;
+    if (options.file_budget_ms) limits.file_budget = std::chrono::milliseconds(*options.file_budget_ms);
+    limits.decode_depth = options.decode_depth;
+    return limits;
+}
+
+// the built-in rules compiled for the engine chosen with --engine (validated while parsing)
+std::shared_ptr<const MatchEngine> scan_engine(const ScanOptions& options) {
+    return make_engine(options.engine, std::make_shared<const RuleSet>(secret_rule_definitions));
+}
+
+// --memory-budget, or half of the cgroup memory limit so rules, stacks and allocator slack fit too
+uint64_t memory_budget_for(const ScanOptions& options) {
+    if (options.memory_budget) return *options.memory_budget;
+    return resource_limits().memory_limit / 2;
+}
+
+// findings spill to disk past --results-memory, by default 64 MiB or a quarter of the memory budget
+void configure_results(CLIInterface& cli, const ScanOptions& options, const MemoryBudget* budget) {
+    uint64_t limit = FindingAggregator::default_memory_limit;
+    if (options.results_memory) {
+        limit = *options.results_memory;
+    } else if (budget && budget->limit()) {
+        limit = std::min(limit, budget->limit() / 4);
+    }
+    cli.configure_results(options.group ? FindingOrder::secret : FindingOrder::location, limit, options.max_locations);
+}
+
+// says what the scan is sized for when a container, cpuset or the user limits it
+void print_resource_limits(CLIInterface& cli, const MemoryBudget& budget) {
+    const ResourceLimits& limits = resource_limits();
+    if (limits.cpus() == limits.host_cpus && limits.memory_limit == 0 && budget.limit() == 0) return;
+    const auto mib = [](uint64_t bytes) { return std::to_string(bytes / (1024 * 1024)) + " MiB"; };
+    std::string text = "Resource limits: " + std::to_string(limits.cpus()) + " of " +
+                       std::to_string(limits.host_cpus) + " CPUs";
+    if (limits.memory_limit) text += ", memory limit " + mib(limits.memory_limit);
+    text += ", memory budget " + (budget.limit() ? mib(budget.limit()) : std::string("unlimited"));
+    cli.print_info(text);
+}
+
+// thread counts adapt at runtime unless the user pins either stage
+PipelineConfig pipeline_config_for(const ScanOptions& options) {
+    PipelineConfig config;
+    config.adaptive = options.readers == 0 && options.matchers == 0;
+    if (options.readers) config.readers = options.readers;
+    if (options.matchers) config.matchers = options.matchers;
+    if (config.adaptive) config.matchers = 1;
+    return config;
+}
+
+// ignored directories, default includes, CLI globs and the repo ignore file share one matcher
+PathFilter build_filter(const std::unordered_set<std::string>& ignored_dirs_set, const ScanOptions& options,
+                        const std::string& root_dir, bool& loaded_ignore_file) {
+    PathFilter filter = PathFilter::from_ignored_dirs(ignored_dirs_set);
+    for (const auto& glob : default_include_globs) filter.add_include(glob);
+    for (const auto& glob : options.include_globs) filter.add_include(glob);
+    for (const auto& glob : options.exclude_globs) filter.add_exclude(glob);
+    loaded_ignore_file = filter.load_ignore_file((fs::path(root_dir) / ignore_file_name).string());
+    return filter;
+}
+
+bool git_ignored(const CLISecretScanner& scanner, const std::string& path, WalkMetrics& walk_metrics) {
+    walk_metrics.gitignore_checks.add();
+    if (!scanner.is_git_ignored(path)) return false;
+    walk_metrics.skipped_gitignore.add();
+    return true;
+}
+
+// excluded directories are pruned by the walker, so only per-file filters remain here;
+// callers that skip the git check must run git_ignored on each candidate themselves
+void walk_tree(const PathFilter& filter, const CLISecretScanner& scanner, WalkMetrics& walk_metrics,
+               const std::function<void(const std::string&)>& on_candidate, bool check_gitignore = true) {
+    const size_t root_prefix_len = scanner.get_root_prefix_len();
+    DirectoryWalker walker(filter);
+    const CLIInterface& cli = scanner.get_interface();
+    size_t unreadable_dirs = walker.walk(scanner.get_root(), [&](const std::string& path_str) {
+        // once the finding limit cancels the scan, the rest of the walk only drains
+        if (cli.finding_limit_reached()) return;
+        walk_metrics.discovered.add();
+        std::string_view rel_path = std::string_view(path_str).substr(root_prefix_len);
+        if (!filter.selects_file(rel_path, scanner.is_valid_extension(path_str))) {
+            walk_metrics.skipped_filter.add();
+            return;
+        }
+        if (check_gitignore && git_ignored(scanner, path_str, walk_metrics)) return;
+        on_candidate(path_str);
+    });
+    walk_metrics.errors.add(unreadable_dirs);
+}
+
+/**
+ * Feed the paths listed by --files-from to on_candidate as they are read, so the first
+ * files are scanned while the producer is still writing. Relative paths are taken from the
+ * scan root. Listed paths that are not regular files, such as files a diff deleted, are
+ * skipped; the extension, glob and git filters only apply with --apply-filters.
+ */
+bool list_files(const ScanOptions& options, const PathFilter& filter, const CLISecretScanner& scanner,
+                WalkMetrics& walk_metrics, const std::function<void(const std::string&)>& on_candidate,
+                bool check_gitignore = true) {
+    int fd = STDIN_FILENO;
+    if (options.files_from != "-") {
+        fd = open(options.files_from.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return false;
+    }
+    const fs::path root(scanner.get_root());
+    const CLIInterface& cli = scanner.get_interface();
+    bool ok = read_path_list(fd, [&](std::string_view listed) {
+        if (cli.finding_limit_reached()) return;
+        walk_metrics.discovered.add();
+        fs::path path(listed);
+        const std::string path_str = (path.is_absolute() ? path : root / path).lexically_normal().string();
+        std::error_code ec;
+        if (!fs::is_regular_file(path_str, ec)) {
+            walk_metrics.skipped_missing.add();
+            return;
+        }
+        if (options.apply_filters) {
+            // paths outside the root are matched as given
+            if (!filter.selects_file(scanner.relative_path(path_str), scanner.is_valid_extension(path_str))) {
+                walk_metrics.skipped_filter.add();
+                return;
+            }
+            if (check_gitignore && git_ignored(scanner, path_str, walk_metrics)) return;
+        }
+        on_candidate(path_str);
+    });
+    if (fd != STDIN_FILENO) close(fd);
+    return ok;
+}
+
+// where candidate files come from: the directory walk, or the list given with --files-from;
+// check_gitignore = false leaves the git check to the caller, as walk_tree does
+using CandidateSource = std::function<void(const std::function<void(const std::string&)>& on_candidate,
+                                           bool check_gitignore)>;
+
+CandidateSource tree_source(const PathFilter& filter, const CLISecretScanner& scanner, WalkMetrics& walk_metrics) {
+    return [&filter, &scanner, &walk_metrics](const std::function<void(const std::string&)>& on_candidate,
+                                               bool check_gitignore) {
+        walk_tree(filter, scanner, walk_metrics, on_candidate, check_gitignore);
+    };
+}
+
+RiskCandidate risk_candidate(const std::string& path, size_t rel_offset) {
+    RiskCandidate candidate;
+    candidate.path = path;
+    candidate.rel_offset = std::min(rel_offset, path.size());
+    std::error_code ec;
+    uint64_t size = fs::file_size(path, ec);
+    candidate.size = ec ? 0 : size;
+    fs::file_time_type modified = fs::last_write_time(path, ec);
+    candidate.age_days = ec ? -1.0
+        : std::chrono::duration<double, std::ratio<86400>>(fs::file_time_type::clock::now() - modified).count();
+    return candidate;
+}
+
+void submit_tree(const CandidateSource& source, const CLISecretScanner& scanner, ScanPipeline& pipeline,
+                 WalkMetrics& walk_metrics, bool prioritize = false) {
+    CLIInterface& cli = scanner.get_interface();
+    if (!prioritize) {
+        source([&](const std::string& path_str) {
+            cli.increment_total_files();
+            pipeline.submit(path_str, scanner);
+        }, true);
+        return;
+    }
+
+    // the whole walk finishes first so the riskiest files anywhere in the tree lead the queue;
+    // the slow git check runs in risk order too, so the first files are queued right away
+    std::vector<RiskCandidate> candidates;
+    std::mutex candidates_mutex;
+    source([&](const std::string& path_str) {
+        RiskCandidate candidate = risk_candidate(path_str, root_relative_offset(path_str, scanner.get_root()));
+        std::lock_guard<std::mutex> lock(candidates_mutex);
+        candidates.push_back(std::move(candidate));
+    }, false);
+    order_by_risk(candidates);
+    for (auto& candidate : candidates) {
+        if (pipeline.cancelled()) break;
+        if (git_ignored(scanner, candidate.path, walk_metrics)) continue;
+        cli.increment_total_files();
+        pipeline.submit(std::move(candidate.path), scanner);
+    }
+}
+
+/**
+ * Walk the whole tree like every other shard, then submit only this shard's files.
+ * Returns the partial result header; findings are added once the scan is done.
+ */
+ShardPartial submit_shard(const ShardSpec& shard, const CandidateSource& source, const CLISecretScanner& scanner,
+                          ScanPipeline& pipeline) {
+    std::vector<ShardCandidate> candidates;
+    std::vector<std::string> paths;
+    std::mutex candidates_mutex;
+    source([&](const std::string& path_str) {
+        std::error_code ec;
+        uint64_t size = fs::file_size(path_str, ec);
+        std::lock_guard<std::mutex> lock(candidates_mutex);
+        candidates.push_back({std::string(scanner.relative_path(path_str)), ec ? 0 : size});
+        paths.push_back(path_str);
+    }, true);
+
+    ShardPartial partial;
+    partial.shard = shard.index;
+    partial.shards = shard.count;
+    partial.root = scanner.get_root();
+    partial.candidates = candidates.size();
+    std::vector<size_t> assignment = assign_shards(candidates, shard.count);
+    for (size_t i = 0; i < paths.size(); ++i) {
+        if (assignment[i] != shard.index) continue;
+        partial.bytes += candidates[i].size;
+        scanner.get_interface().increment_total_files();
+        pipeline.submit(paths[i], scanner);
+    }
+    return partial;
+}
+
+// derived gauges are recomputed right before each snapshot
+void refresh_metrics(MetricsRegistry& metrics, ScanPipeline& pipeline) {
+    pipeline.sample_metrics();
+    double elapsed = std::max(metrics.elapsed_seconds(), 1e-9);
+    metrics.gauge("scanner_elapsed_seconds", "Seconds since the scan started").set(elapsed);
+    metrics.gauge("scanner_bytes_per_second", "Average read throughput since the scan started")
+        .set(static_cast<double>(metrics.counter("scanner_bytes_read_total", "").value()) / elapsed);
+    metrics.gauge("scanner_files_per_second", "Average scan rate since the scan started")
+        .set(static_cast<double>(metrics.counter("scanner_files_scanned_total", "").value()) / elapsed);
+    for (const char* stage : {"read", "match"}) {
+        double busy = metrics.histogram("scanner_stage_duration_seconds", "", {{"stage", stage}}).sum_seconds();
+        double workers = metrics.gauge("scanner_workers", "", {{"stage", stage}}).value();
+        metrics.gauge("scanner_worker_utilization", "Fraction of worker time spent busy per stage",
+                      {{"stage", stage}}).set(workers > 0 ? busy / (elapsed * workers) : 0.0);
+    }
+}
+
+std::unique_ptr<MetricsExporter> start_metrics(const ScanOptions& options, MetricsRegistry& metrics,
+                                               ScanPipeline& pipeline) {
+    if (options.metrics_file.empty()) return nullptr;
+    return std::make_unique<MetricsExporter>(metrics, options.metrics_file,
+                                             std::chrono::seconds(options.metrics_interval),
+                                             [&metrics, &pipeline] { refresh_metrics(metrics, pipeline); });
+}
+
+void finish_metrics(std::unique_ptr<MetricsExporter>& exporter, const ScanOptions& options,
+                    MetricsRegistry& metrics, ScanPipeline& pipeline, CLIInterface& cli) {
+    std::string error;
+    if (exporter && !exporter->stop(error)) cli.print_error(error);
+    if (!options.metrics_json_path.empty()) {
+        refresh_metrics(metrics, pipeline);
+        if (!metrics.write_file(options.metrics_json_path, true, error)) cli.print_error(error);
+    }
+}
+
+/**
+ * Scan every root listed in the manifest with one compiled rule set and one pipeline.
+ * Roots are walked one after another while earlier roots are still being matched, so the
+ * workers stay busy across repository boundaries; each repository's results are printed
+ * as soon as its last file is done.
+ */
+int run_batch(const ScanOptions& options, CLIInterface& cli) {
+    std::ifstream manifest(options.batch_manifest);
+    if (!manifest) {
+        cli.print_error("Cannot read manifest '" + options.batch_manifest + "'");
+        return 1;
+    }
+    std::vector<std::string> roots;
+    std::string line;
+    while (std::getline(manifest, line)) {
+        size_t end = line.find_last_not_of(" \t\r");
+        size_t begin = line.find_first_not_of(" \t");
+        if (end == std::string::npos || line[begin] == '#') continue;
+        roots.push_back(line.substr(begin, end - begin + 1));
+    }
+    cli.print_info("Scanning " + std::to_string(roots.size()) + " directories from " + options.batch_manifest);
+
+    std::unordered_set<std::string> ignored_dirs_set(ignored_dirs.begin(), ignored_dirs.end());
+    std::unordered_set<std::string> valid_ext_set(valid_extensions.begin(), valid_extensions.end());
+    MetricsRegistry metrics;
+    WalkMetrics walk_metrics(metrics);
+    auto engine = scan_engine(options);
+    const auto& rules = engine->shared_rules();
+    const ScanLimits limits = scan_limits(options);
+    MemoryBudget memory(memory_budget_for(options));
+    print_resource_limits(cli, memory);
+
+    struct Repo {
+        CLIInterface cli;
+        std::unique_ptr<CLISecretScanner> scanner;
+    };
+    std::vector<std::unique_ptr<Repo>> repos;
+    repos.reserve(roots.size());
+    std::mutex output_mutex;
+    std::atomic<int> secrets_found{0};
+    std::atomic<int> files_scanned{0};
+    bool had_errors = false;
+
+    auto emit = [&](const CLISecretScanner& repo_scanner) {
+        CLIInterface& repo_cli = repo_scanner.get_interface();
+        secrets_found += repo_cli.get_secrets_found();
+        files_scanned += repo_cli.get_files_scanned();
+        std::lock_guard<std::mutex> lock(output_mutex);
+        repo_cli.print_repo_results(repo_scanner.get_root());
+    };
+
+    // files always name their repository's scanner; the default one is never used
+    SecretScanner unused_default(ignored_dirs_set, valid_ext_set, rules);
+    PipelineConfig pipeline_config = pipeline_config_for(options);
+    pipeline_config.metrics = &metrics;
+    pipeline_config.memory = &memory;
+    ScanPipeline pipeline(unused_default, pipeline_config, [&](const std::string&, const SecretScanner& s) {
+        const auto& repo_scanner = static_cast<const CLISecretScanner&>(s);
+        repo_scanner.get_interface().increment_files_scanned();
+        if (repo_scanner.get_interface().try_complete()) emit(repo_scanner);
+    });
+    std::unique_ptr<MetricsExporter> exporter = start_metrics(options, metrics, pipeline);
+
+    for (const auto& input : roots) {
+        std::error_code ec;
+        fs::path root = fs::canonical(input, ec);
+        if (ec || !fs::is_directory(root, ec)) {
+            std::lock_guard<std::mutex> lock(output_mutex);
+            std::cout << "{" << R"("repo":")" << input << "\"," << R"("error":"not a directory")" << "}" << std::endl;
+            had_errors = true;
+            continue;
+        }
+
+        repos.push_back(std::make_unique<Repo>());
+        Repo& repo = *repos.back();
+        repo.cli.set_memory_budget(&memory);
+        configure_results(repo.cli, options, &memory);
+        repo.scanner = std::make_unique<CLISecretScanner>(ignored_dirs_set, valid_ext_set, rules, &repo.cli, metrics);
+        repo.scanner->set_limits(limits);
+        repo.scanner->set_engine(engine);
+        repo.scanner->set_root(root.string());
+
+        bool loaded_ignore_file = false;
+        PathFilter filter = build_filter(ignored_dirs_set, options, root.string(), loaded_ignore_file);
+        submit_tree(tree_source(filter, *repo.scanner, walk_metrics), *repo.scanner, pipeline, walk_metrics);
+
+        repo.cli.set_walk_complete();
+        if (repo.cli.try_complete()) emit(*repo.scanner);
+    }
+    pipeline.finish();
+    finish_metrics(exporter, options, metrics, pipeline, cli);
+
+    cli.print_info("Batch complete: " + std::to_string(repos.size()) + " directories, " +
+                   std::to_string(files_scanned.load()) + " files scanned, " +
+                   std::to_string(secrets_found.load()) + " secrets found");
+    return (had_errors || secrets_found.load() > 0) ? 1 : 0;
+}
+
+// the watcher run_watch is waiting on; stop() only writes to its wake pipe, so it is async-signal-safe
+std::atomic<DirectoryWatcher*> active_watcher{nullptr};
+
+void stop_watching(int) {
+    if (DirectoryWatcher* watcher = active_watcher.load()) watcher->stop();
+}
+
+/**
+ * Scan the tree once, then rescan only the files inotify reports as changed. Every finding
+ * that appears or disappears is printed as one NDJSON delta line, and each batch ends with
+ * a {"watch":...} summary line. Runs until SIGINT or SIGTERM, then shuts down like a
+ * normal scan so metrics are written.
+ */
+int run_watch(const ScanOptions& options, CLIInterface& cli, const std::string& root_dir) {
+    std::unordered_set<std::string> ignored_dirs_set(ignored_dirs.begin(), ignored_dirs.end());
+    std::unordered_set<std::string> valid_ext_set(valid_extensions.begin(), valid_extensions.end());
+    MetricsRegistry metrics;
+    WalkMetrics walk_metrics(metrics);
+    auto engine = scan_engine(options);
+    CLISecretScanner scanner(ignored_dirs_set, valid_ext_set, engine->shared_rules(), &cli, metrics);
+    scanner.set_limits(scan_limits(options));
+    scanner.set_engine(engine);
+    scanner.set_root(root_dir);
+
+    bool loaded_ignore_file = false;
+    PathFilter filter = build_filter(ignored_dirs_set, options, root_dir, loaded_ignore_file);
+    Baseline baseline;
+    if (!options.baseline_path.empty()) {
+        std::string error;
+        if (!baseline.load(options.baseline_path, error)) {
+            cli.print_error(error);
+            return 1;
+        }
+        scanner.use_baseline(&baseline, false);
+    }
+
+    // watches go up before the initial walk so nothing changed during it is missed
+    DirectoryWatcher watcher(filter);
+    std::string error;
+    if (!watcher.start(root_dir, error)) {
+        cli.print_error(error);
+        return 1;
+    }
+
+    std::mutex done_mutex;
+    std::condition_variable done_cv;
+    size_t outstanding = 0;
+    MemoryBudget memory(memory_budget_for(options));
+    cli.set_memory_budget(&memory);
+    configure_results(cli, options, &memory);
+    PipelineConfig pipeline_config = pipeline_config_for(options);
+    pipeline_config.metrics = &metrics;
+    pipeline_config.memory = &memory;
+    ScanPipeline pipeline(scanner, pipeline_config, [&](const std::string&, const SecretScanner&) {
+        cli.increment_files_scanned();
+        std::lock_guard<std::mutex> lock(done_mutex);
+        if (--outstanding == 0) done_cv.notify_all();
+    });
+    std::unique_ptr<MetricsExporter> exporter = start_metrics(options, metrics, pipeline);
+
+    // findings of every file, in report order, as of its last scan
+    std::map<std::string, std::vector<FindingRecord>> current;
+    size_t secrets_found = 0;
+    size_t added = 0;
+    size_t removed = 0;
+
+    auto same_finding_less = [](const FindingRecord& a, const FindingRecord& b) {
+        if (finding_less(a, b)) return true;
+        if (finding_less(b, a)) return false;
+        return std::tie(a.line, a.column) < std::tie(b.line, b.column);
+    };
+    auto emit = [](const char* delta, const FindingRecord& finding) {
+        std::cout << R"({"delta":")" << delta << "\"," << finding_to_json(finding).substr(1) << "\n";
+    };
+    auto forget = [&](const std::string& path) {
+        const std::string prefix = path + "/";
+        for (auto it = current.lower_bound(path); it != current.end();) {
+            if (it->first != path && it->first.compare(0, prefix.size(), prefix) != 0) break;
+            for (const auto& finding : it->second) emit("remove", finding);
+            removed += it->second.size();
+            secrets_found -= it->second.size();
+            it = current.erase(it);
+        }
+    };
+    auto is_candidate = [&](const std::string& path) {
+        std::error_code ec;
+        if (!fs::is_regular_file(path, ec)) return false;
+        std::string_view rel_path = std::string_view(path).substr(scanner.get_root_prefix_len());
+        return filter.selects_file(rel_path, scanner.is_valid_extension(path)) && !scanner.is_git_ignored(path);
+    };
+    // paths that are gone or no longer selected simply come back without findings;
+    // returns the number of files actually scanned
+    auto rescan = [&](const std::vector<std::string>& paths) {
+        std::vector<std::string> candidates;
+        for (const auto& path : paths) {
+            if (is_candidate(path)) candidates.push_back(path);
+        }
+        {
+            std::lock_guard<std::mutex> lock(done_mutex);
+            outstanding += candidates.size();
+        }
+        for (const auto& path : candidates) pipeline.submit(path, scanner);
+        {
+            std::unique_lock<std::mutex> lock(done_mutex);
+            done_cv.wait(lock, [&] { return outstanding == 0; });
+        }
+
+        std::map<std::string, std::vector<FindingRecord>> fresh;
+        for (auto& finding : cli.take_findings()) fresh[finding.file].push_back(std::move(finding));
+        for (const auto& [path, reason] : cli.take_partial_files()) {
+            std::cout << R"({"delta":"partial","partial_path":")" << json_escape(path) << R"(","reason":")"
+                      << json_escape(reason) << "\"}\n";
+        }
+        for (const auto& path : paths) {
+            std::vector<FindingRecord>& now = fresh[path];
+            std::sort(now.begin(), now.end(), same_finding_less);
+            auto it = current.find(path);
+            const std::vector<FindingRecord> none;
+            const std::vector<FindingRecord>& before = it == current.end() ? none : it->second;
+
+            std::vector<FindingRecord> gone, appeared;
+            std::set_difference(before.begin(), before.end(), now.begin(), now.end(), std::back_inserter(gone),
+                                same_finding_less);
+            std::set_difference(now.begin(), now.end(), before.begin(), before.end(),
+                                std::back_inserter(appeared), same_finding_less);
+            for (const auto& finding : gone) emit("remove", finding);
+            for (const auto& finding : appeared) emit("add", finding);
+            removed += gone.size();
+            added += appeared.size();
+            secrets_found = secrets_found + appeared.size() - gone.size();
+
+            if (now.empty()) {
+                if (it != current.end()) current.erase(it);
+            } else {
+                current[path] = std::move(now);
+            }
+        }
+        return candidates.size();
+    };
+    auto walk_all = [&] {
+        std::vector<std::string> paths;
+        std::mutex paths_mutex;
+        walk_tree(filter, scanner, walk_metrics, [&](const std::string& path) {
+            std::lock_guard<std::mutex> lock(paths_mutex);
+            paths.push_back(path);
+        });
+        // files that vanished while events were lost still need their findings removed
+        std::unordered_set<std::string> seen(paths.begin(), paths.end());
+        for (const auto& entry : current) {
+            if (!seen.count(entry.first)) paths.push_back(entry.first);
+        }
+        return paths;
+    };
+    auto summary = [&](const char* state, size_t files) {
+        std::cout << "{"
+                  << R"("watch":")" << state << "\","
+                  << R"("files_scanned":)" << files << ","
+                  << R"("added":)" << added << ","
+                  << R"("removed":)" << removed << ","
+                  << R"("secrets_found":)" << secrets_found
+                  << "}" << std::endl;
+        added = 0;
+        removed = 0;
+    };
+
+    summary("ready", rescan(walk_all()));
+
+    active_watcher = &watcher;
+    struct sigaction action{};
+    action.sa_handler = stop_watching;
+    sigemptyset(&action.sa_mask);
+    struct sigaction previous_int{}, previous_term{};
+    sigaction(SIGINT, &action, &previous_int);
+    sigaction(SIGTERM, &action, &previous_term);
+
+    WatchBatch batch;
+    while (watcher.next_batch(batch, std::chrono::milliseconds(30), std::chrono::milliseconds(1000))) {
+        std::vector<std::string> paths;
+        if (batch.overflow) {
+            paths = walk_all();
+        } else {
+            for (const auto& path : batch.removed) forget(path);
+            paths = std::move(batch.changed);
+        }
+        summary("update", rescan(paths));
+    }
+    sigaction(SIGINT, &previous_int, nullptr);
+    sigaction(SIGTERM, &previous_term, nullptr);
+    active_watcher = nullptr;
+    pipeline.finish();
+    finish_metrics(exporter, options, metrics, pipeline, cli);
+    return 0;
+}
+
+bool write_shard_result(const ScanOptions& options, ShardPartial& shard_partial, const CLISecretScanner& scanner) {
+    CLIInterface& cli = scanner.get_interface();
+    shard_partial.total_files = static_cast<size_t>(cli.get_total_files());
+    shard_partial.files_scanned = static_cast<size_t>(cli.get_files_scanned());
+    shard_partial.secrets_suppressed = static_cast<size_t>(cli.get_secrets_suppressed());
+    shard_partial.partial_files = cli.sorted_partial_files();
+    for (auto& entry : shard_partial.partial_files) entry.first = std::string(scanner.relative_path(entry.first));
+    
+    std::string partial_path = options.partial_output;
+    if (partial_path.empty()) {
+        partial_path = "shard-" + std::to_string(options.shard.index) + "-of-" +
+                       std::to_string(options.shard.count) + ".ndjson";
+    }
+    // findings go straight from the aggregator, and its spilled runs, into the file
+    FindingSource findings = [&](const std::function<void(const FindingRecord&)>& visit, std::string& source_error) {
+        FindingRecord relative;
+        return cli.for_each_finding([&](const FindingRecord& finding) {
+            relative = finding;
+            relative.file = std::string(scanner.relative_path(finding.file));
+            visit(relative);
+        }, source_error);
+    };
+    std::string error;
+    if (!write_shard_partial(partial_path, shard_partial, error, findings)) {
+        cli.print_error(error);
+        return false;
+    }
+    cli.print_info("Shard " + std::to_string(options.shard.index) + "/" + std::to_string(options.shard.count) +
+                   ": " + std::to_string(shard_partial.total_files) + " of " +
+                   std::to_string(shard_partial.candidates) + " files, partial result written to " + partial_path);
+    return true;
+}
+
+/**
+ * Combine the partial results of a sharded scan and report them like a single-node run.
+ */
+int run_merge(const ScanOptions& options, CLIInterface& cli) {
+    std::vector<ShardPartial> partials(options.merge_inputs.size());
+    std::string error;
+    // findings stream into the aggregator, which spills them, instead of into the partials;
+    // paths are resolved against the first partial's root, like the merged result
+    configure_results(cli, options, nullptr);
+    for (size_t i = 0; i < partials.size(); ++i) {
+        auto add_finding = [&](FindingRecord finding) { cli.add_merged_finding(std::move(finding), partials[0].root); };
+        if (!read_shard_partial(options.merge_inputs[i], partials[i], error, add_finding)) {
+            cli.print_error(error);
+            return 1;
+        }
+    }
+    ShardPartial merged;
+    if (!merge_shard_partials(partials, merged, error)) {
+        cli.print_error(error);
+        return 1;
+    }
+    cli.print_info("Merged " + std::to_string(partials.size()) + " shards of " + merged.root);
+    cli.load_merged(merged);
+    
+    if (cli.get_total_files() == 0) {
+        cli.print_info("No files found to scan in the specified directory.");
+        return 0;
+    }
+    cli.print_results();
+    return (cli.get_secrets_found() > 0) ? 1 : 0;
+}
+
+// prints each finding the moment it is scanned; stream mode has no end-of-scan report
+class StreamReportScanner : public SecretScanner {
+private:
+    std::ostream& out;
+    mutable size_t found = 0;
+
+public:
+    StreamReportScanner(std::shared_ptr<const RuleSet> rules, std::ostream& out_)
+        : SecretScanner({}, {}, std::move(rules)), out(out_) {}
+
+    size_t get_found() const { return found; }
+
+    void report_findings(const std::string& file_path, const FindingBuffer& findings) const override {
+        for (const Finding& finding : findings) {
+            out << finding_to_json({file_path, static_cast<int>(finding.line), static_cast<int>(finding.column),
+                                    finding.offset, get_rules().rules()[finding.rule].name,
+                                    std::string(findings.text(finding))})
+                << '\n';
+        }
+        out.flush();
+        found += findings.size();
+    }
+
+    void report_partial_scan(const std::string& file_path, const std::string& reason) const override {
+        std::cerr << "warning: partially scanned " << file_path << ": " << reason << std::endl;
+    }
+};
+
+/**
+ * Scan stdin, or the FIFO or file named on the command line, while it is being written.
+ * Findings are printed as soon as the line holding them is complete. With --redact the
+ * input is copied to stdout with every match masked and findings go to stderr instead.
+ */
+int run_stream(const ScanOptions& options, CLIInterface& cli) {
+    int fd = STDIN_FILENO;
+    std::string name = "<stdin>";
+    if (!options.directory.empty() && options.directory != "-") {
+        name = options.directory;
+        fd = open(name.c_str(), O_RDONLY);
+        if (fd < 0) {
+            cli.print_error("Cannot open '" + name + "' for streaming");
+            return 1;
+        }
+    }
+
+    // unbounded input has no meaningful per-file CPU budget
+    ScanLimits limits = scan_limits(options);
+    limits.file_budget = std::chrono::milliseconds(0);
+    auto engine = scan_engine(options);
+    StreamReportScanner scanner(engine->shared_rules(), options.redact ? std::cerr : std::cout);
+    scanner.set_limits(limits);
+    scanner.set_engine(engine);
+    IncrementalScan::Output redacted;
+    if (options.redact) {
+        redacted = [](std::string_view text) { std::cout.write(text.data(), static_cast<std::streamsize>(text.size())); };
+    }
+    IncrementalScan scan(scanner, name, redacted);
+
+    std::vector<char> buffer(256 * 1024);
+    bool read_error = false;
+    while (true) {
+        ssize_t got = read(fd, buffer.data(), buffer.size());
+        if (got < 0 && errno == EINTR) continue;
+        if (got <= 0) {
+            read_error = got < 0;
+            break;
+        }
+        scan.feed(std::string_view(buffer.data(), static_cast<size_t>(got)));
+        if (options.redact) std::cout.flush();
+    }
+    scan.finish();
+    std::cout.flush();
+    if (fd != STDIN_FILENO) close(fd);
+    if (read_error) {
+        std::cerr << "warning: read error on " << name << ", stopped after " << scan.bytes_scanned() << " bytes"
+                  << std::endl;
+    }
+    return scanner.get_found() > 0 ? 1 : 0;
+}
+
+/**
+ * Record the scan into per-thread rings when --trace is given; the trace is written once
+ * every worker has finished.
+ */
+std::unique_ptr<TraceRecorder> start_trace(const ScanOptions& options) {
+    if (options.trace_path.empty()) return nullptr;
+    // per-rule spans multiply the event count by the number of rules, so give them room
+    auto recorder = std::make_unique<TraceRecorder>(options.trace_rules,
+                                                    options.trace_rules ? 256 * 1024 : 64 * 1024);
+    recorder->start();
+    TraceRecorder::name_thread("main");
+    return recorder;
+}
+
+bool finish_trace(std::unique_ptr<TraceRecorder>& recorder, const ScanOptions& options) {
+    if (!recorder) return true;
+    recorder->stop();
+    std::string error;
+    if (!recorder->write(options.trace_path, error)) {
+        std::cerr << "error: " << error << std::endl;
+        return false;
+    }
+    // stderr, so a --stream scan keeps stdout to itself
+    std::cerr << "Trace of " << recorder->recorded() << " spans written to " << options.trace_path;
+    if (recorder->dropped()) std::cerr << " (" << recorder->dropped() << " oldest spans dropped)";
+    std::cerr << std::endl;
+    return true;
+}
+
+// everything main does once the options are parsed
+int run(const ScanOptions& options, CLIInterface& cli) {
+    // stdout carries findings or the redacted input, so nothing else may be printed
+    if (options.stream) {
+        return run_stream(options, cli);
+    }
     
     cli.print_banner();
     
-    if (argc > 1 && (std::string(argv[1]) == "--help" || std::string(argv[1]) == "-h")) {
+    if (options.show_help) {
         cli.print_help();
         return 0;
     }
     
-    std::string input_dir = (argc > 1) ? argv[1] : "";
-    std::string root_dir = cli.resolve_directory(input_dir);
+    if (options.merge) {
+        return run_merge(options, cli);
+    }
+    
+    if (!options.batch_manifest.empty()) {
+        return run_batch(options, cli);
+    }
+    
+    std::string input_dir = options.directory;
+    // a file list names its own files; without a directory they are relative to the working directory
+    std::string root_dir = !options.files_from.empty() && input_dir.empty() ? fs::current_path().string()
+                                                                            : cli.resolve_directory(input_dir);
     
     if (!input_dir.empty()) {
         cli.print_info("Input: '" + input_dir + "' → Resolved to: '" + root_dir + "'");
@@ -265,53 +1349,147 @@ int main(int argc, char* argv[]) {
         return 1;
     }
     
-    cli.print_info("Scanning directory: " + root_dir);
+    if (options.watch) {
+        cli.print_info("Watching directory: " + root_dir);
+        return run_watch(options, cli, root_dir);
+    }
+    
+    if (options.files_from.empty()) {
+        cli.print_info("Scanning directory: " + root_dir);
+    } else {
+        cli.print_info("Scanning files listed in " + (options.files_from == "-" ? std::string("stdin") : options.files_from) +
+                       " relative to " + root_dir);
+    }
     
     std::unordered_set<std::string> ignored_dirs_set(ignored_dirs.begin(), ignored_dirs.end());
     std::unordered_set<std::string> valid_ext_set(valid_extensions.begin(), valid_extensions.end());
     
-    CLISecretScanner scanner(ignored_dirs_set, valid_ext_set, secret_patterns, &cli);
+    // metrics are always collected; they are only written out when asked for
+    MetricsRegistry metrics;
+    WalkMetrics walk_metrics(metrics);
     
-    cli.print_info("Analyzing project structure...");
-    cli.count_files(root_dir, ignored_dirs_set, valid_ext_set, scanner);
+    auto engine = scan_engine(options);
+    CLISecretScanner scanner(ignored_dirs_set, valid_ext_set, engine->shared_rules(), &cli, metrics);
+    scanner.set_limits(scan_limits(options));
+    scanner.set_engine(engine);
+    scanner.set_root(root_dir);
     
-    if (cli.get_total_files() == 0) {
-        cli.print_info("No files found to scan in the specified directory.");
-        return 0;
+    bool loaded_ignore_file = false;
+    PathFilter filter = build_filter(ignored_dirs_set, options, root_dir, loaded_ignore_file);
+    if (loaded_ignore_file) {
+        cli.print_info("Loaded ignore patterns from " + ignore_file_name);
     }
     
-    ThreadPool pool(std::thread::hardware_concurrency());
-    std::vector<std::future<void>> futures;
+    Baseline baseline;
+    if (!options.baseline_path.empty()) {
+        std::string error;
+        if (baseline.load(options.baseline_path, error)) {
+            cli.print_info("Loaded baseline with " + std::to_string(baseline.size()) + " known findings");
+        } else if (!options.update_baseline) {
+            cli.print_error(error);
+            return 1;
+        }
+    }
+    scanner.use_baseline(options.baseline_path.empty() ? nullptr : &baseline, !options.write_baseline_path.empty());
+    
+    // bounded discover -> read -> match stages; a full queue blocks the walker, and the
+    // memory budget blocks readers while buffers in flight and findings fill it
+    MemoryBudget memory(memory_budget_for(options));
+    print_resource_limits(cli, memory);
+    cli.set_memory_budget(&memory);
+    configure_results(cli, options, &memory);
+    PipelineConfig pipeline_config = pipeline_config_for(options);
+    pipeline_config.metrics = &metrics;
+    pipeline_config.memory = &memory;
+    ScanPipeline pipeline(scanner, pipeline_config, [&cli](const std::string&, const SecretScanner&) {
+        cli.increment_files_scanned();
+    });
+    std::unique_ptr<MetricsExporter> exporter = start_metrics(options, metrics, pipeline);
+    if (options.max_findings) {
+        cli.set_finding_limit(options.max_findings, [&pipeline] { pipeline.cancel(); });
+    }
     
     cli.start_progress_indicator();
     
-    try {
-        for (const auto& entry : fs::recursive_directory_iterator(root_dir)) {
-            if (!entry.is_regular_file()) continue;
-            
-            const auto& path = entry.path();
-            if (scanner.is_ignored_dir(path.parent_path())) continue;
-            if (!scanner.is_valid_extension(path)) continue;
-            if (scanner.is_git_ignored(path.string())) continue;
-            
-            futures.emplace_back(pool.enqueue([path_str = path.string(), &scanner]() {
-                scanner.scan_file_with_callback(path_str);
-            }));
-        }
-    } catch (const fs::filesystem_error& e) {
-        cli.set_scanning_complete();
-        cli.print_error("Filesystem error: " + std::string(e.what()));
-        return 1;
+    bool list_failed = false;
+    CandidateSource source = tree_source(filter, scanner, walk_metrics);
+    if (!options.files_from.empty()) {
+        source = [&](const std::function<void(const std::string&)>& on_candidate, bool check_gitignore) {
+            list_failed = !list_files(options, filter, scanner, walk_metrics, on_candidate, check_gitignore);
+        };
     }
-    
-    for (auto& f : futures) {
-        f.get();
+    ShardPartial shard_partial;
+    if (options.shard.enabled()) {
+        shard_partial = submit_shard(options.shard, source, scanner, pipeline);
+    } else {
+        submit_tree(source, scanner, pipeline, walk_metrics, options.prioritize);
     }
+    pipeline.finish();
+    finish_metrics(exporter, options, metrics, pipeline, cli);
     
     cli.set_scanning_complete();
     std::this_thread::sleep_for(std::chrono::milliseconds(200));
     
+    if (list_failed) {
+        cli.print_error("Cannot read the file list '" + options.files_from + "'");
+        return 1;
+    }
+    
+    if (cli.finding_limit_reached()) {
+        cli.print_info("Stopped after " + std::to_string(options.max_findings) + " finding(s); " +
+                       std::to_string(pipeline.files_cancelled()) + " queued files were not scanned");
+    }
+    
+    // a shard writes its partial result even when it was assigned no files
+    if (options.shard.enabled() && !write_shard_result(options, shard_partial, scanner)) {
+        return 1;
+    }
+    
+    // a scan of an emptied tree still rewrites the baseline, with no findings in it
+    auto write_baseline = [&] {
+        if (options.write_baseline_path.empty()) return true;
+        std::string error;
+        if (!Baseline::write(options.write_baseline_path, cli.get_fingerprints(), error)) {
+            cli.print_error(error);
+            return false;
+        }
+        cli.print_info("Baseline written to " + options.write_baseline_path);
+        return true;
+    };
+    
+    if (cli.get_total_files() == 0) {
+        cli.print_info("No files found to scan in the specified directory.");
+        return write_baseline() ? 0 : 1;
+    }
+    
     cli.print_results();
     
+    if (!write_baseline()) return 1;
+    
     return (cli.get_secrets_found() > 0) ? 1 : 0;
-}
\ No newline at end of file
+}
+
+int main(int argc, char* argv[]) {
+    CLIInterface cli;
+    
+    ScanOptions options;
+    try {
+        options = parse_options(argc, argv);
+    } catch (const std::invalid_argument& e) {
+        cli.print_banner();
+        cli.print_error(e.what());
+        cli.print_help();
+        return 1;
+    }
+    
+    // before any thread starts: nice values and I/O classes are inherited per thread
+    if (options.low_priority) {
+        std::string error;
+        if (!lower_process_priority(error)) std::cerr << "warning: " << error << std::endl;
+    }
+    
+    std::unique_ptr<TraceRecorder> trace = start_trace(options);
+    int status = run(options, cli);
+    if (!finish_trace(trace, options) && status == 0) status = 1;
+    return status;
+}
@@ -0,0 +1,318 @@
+/**
+ * @file metrics.cpp
+ * @brief Implements the metrics registry, its Prometheus and JSON renderers and the exporter.
+ *
+ * Metrics are updated with relaxed atomics from the scanning threads and read only when a
+ * snapshot is rendered, so instrumentation costs a few uncontended atomic adds per file.
+ *
+ * Features:
+ * - Counters, gauges and latency histograms with optional labels.
+ * - Prometheus text exposition format for the node_exporter textfile collector.
+ * - JSON summary with histogram quantile estimates.
+ * - Periodic export to a file that is replaced atomically.
+ *
+ * @author Dorna Raj Gyawali <dronarajgyawali@gmail.com>
+ * @date 2025
+ */
+
+#include "metrics.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+const std::vector<double>& default_latency_bounds() {
+    static const std::vector<double> bounds = {
+        0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025,
+        0.05, 0.1, 0.25, 0.5, 1.0, 2.5, 5.0, 10.0,
+    };
+    return bounds;
+}
+
+std::string format_number(double v) {
+    if (std::isnan(v)) return "NaN";
+    if (std::isinf(v)) return v > 0 ? "+Inf" : "-Inf";
+    std::ostringstream ss;
+    if (v == std::floor(v) && std::fabs(v) < 1e15) {
+        ss << static_cast<long long>(v);
+    } else {
+        ss << std::setprecision(9) << v;
+    }
+    return ss.str();
+}
+
+// JSON has no representation for infinities or NaN
+std::string format_json_number(double v) {
+    return std::isfinite(v) ? format_number(v) : "null";
+}
+
+std::string escape(const std::string& s, bool json) {
+    std::string out;
+    out.reserve(s.size());
+    for (char c : s) {
+        if (c == '\\' || c == '"') {
+            out += '\\';
+            out += c;
+        } else if (c == '\n') {
+            out += "\\n";
+        } else if (json && static_cast<unsigned char>(c) < 0x20) {
+            char buf[8];
+            std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+            out += buf;
+        } else {
+            out += c;
+        }
+    }
+    return out;
+}
+
+std::string prometheus_labels(const MetricLabels& labels, const std::string& extra = "") {
+    if (labels.empty() && extra.empty()) return "";
+    std::string out = "{";
+    for (size_t i = 0; i < labels.size(); ++i) {
+        if (i) out += ",";
+        out += labels[i].first + "=\"" + escape(labels[i].second, false) + "\"";
+    }
+    if (!extra.empty()) {
+        if (!labels.empty()) out += ",";
+        out += extra;
+    }
+    return out + "}";
+}
+
+std::string json_labels(const MetricLabels& labels) {
+    std::string out = "{";
+    for (size_t i = 0; i < labels.size(); ++i) {
+        if (i) out += ",";
+        out += "\"" + escape(labels[i].first, true) + "\":\"" + escape(labels[i].second, true) + "\"";
+    }
+    return out + "}";
+}
+
+} // namespace
+
+Histogram::Histogram(std::vector<double> bounds_)
+    : upper_bounds(bounds_.empty() ? default_latency_bounds() : std::move(bounds_)),
+      buckets(new std::atomic<uint64_t>[upper_bounds.size() + 1])
+{
+    std::sort(upper_bounds.begin(), upper_bounds.end());
+    for (size_t i = 0; i <= upper_bounds.size(); ++i) buckets[i] = 0;
+}
+
+void Histogram::observe(std::chrono::nanoseconds duration) {
+    long long ns = std::max<long long>(0, duration.count());
+    double seconds = static_cast<double>(ns) / 1e9;
+    size_t index = static_cast<size_t>(
+        std::lower_bound(upper_bounds.begin(), upper_bounds.end(), seconds) - upper_bounds.begin());
+    buckets[index].fetch_add(1, std::memory_order_relaxed);
+    total.fetch_add(1, std::memory_order_relaxed);
+    sum_ns.fetch_add(static_cast<uint64_t>(ns), std::memory_order_relaxed);
+}
+
+std::vector<uint64_t> Histogram::cumulative_counts() const {
+    std::vector<uint64_t> counts(upper_bounds.size() + 1);
+    uint64_t running = 0;
+    for (size_t i = 0; i < counts.size(); ++i) {
+        running += buckets[i].load(std::memory_order_relaxed);
+        counts[i] = running;
+    }
+    return counts;
+}
+
+double Histogram::quantile(double q) const {
+    std::vector<uint64_t> counts = cumulative_counts();
+    uint64_t n = counts.back();
+    if (n == 0) return 0.0;
+    double rank = std::clamp(q, 0.0, 1.0) * static_cast<double>(n);
+    for (size_t i = 0; i < counts.size(); ++i) {
+        if (static_cast<double>(counts[i]) < rank) continue;
+        // the +Inf bucket has no upper edge; report its lower edge
+        if (i == upper_bounds.size()) return upper_bounds.empty() ? 0.0 : upper_bounds.back();
+        double lower = i == 0 ? 0.0 : upper_bounds[i - 1];
+        uint64_t below = i == 0 ? 0 : counts[i - 1];
+        uint64_t in_bucket = counts[i] - below;
+        double fraction = in_bucket ? (rank - static_cast<double>(below)) / static_cast<double>(in_bucket) : 1.0;
+        return lower + (upper_bounds[i] - lower) * fraction;
+    }
+    return upper_bounds.empty() ? 0.0 : upper_bounds.back();
+}
+
+MetricsRegistry::MetricsRegistry() : start(std::chrono::steady_clock::now()) {}
+
+double MetricsRegistry::elapsed_seconds() const {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+MetricsRegistry::Series& MetricsRegistry::find_or_add(const std::string& name, const std::string& help,
+                                                      Type type, const MetricLabels& labels) {
+    auto family = std::find_if(families.begin(), families.end(), [&](const Family& f) { return f.name == name; });
+    if (family == families.end()) {
+        families.push_back({name, help, type, {}});
+        family = families.end() - 1;
+    } else if (family->type != type) {
+        throw std::invalid_argument("metric '" + name + "' is already registered with another type");
+    }
+    for (auto& series : family->series) {
+        if (series.labels == labels) return series;
+    }
+    Series series;
+    series.labels = labels;
+    family->series.push_back(std::move(series));
+    return family->series.back();
+}
+
+Counter& MetricsRegistry::counter(const std::string& name, const std::string& help, const MetricLabels& labels) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Series& series = find_or_add(name, help, Type::COUNTER, labels);
+    if (!series.counter) series.counter = std::make_unique<Counter>();
+    return *series.counter;
+}
+
+Gauge& MetricsRegistry::gauge(const std::string& name, const std::string& help, const MetricLabels& labels) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Series& series = find_or_add(name, help, Type::GAUGE, labels);
+    if (!series.gauge) series.gauge = std::make_unique<Gauge>();
+    return *series.gauge;
+}
+
+Histogram& MetricsRegistry::histogram(const std::string& name, const std::string& help, const MetricLabels& labels) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Series& series = find_or_add(name, help, Type::HISTOGRAM, labels);
+    if (!series.histogram) series.histogram = std::make_unique<Histogram>();
+    return *series.histogram;
+}
+
+void MetricsRegistry::write_prometheus(std::ostream& out) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const auto& family : families) {
+        const char* type = family.type == Type::COUNTER ? "counter"
+                         : family.type == Type::GAUGE ? "gauge" : "histogram";
+        out << "# HELP " << family.name << " " << escape(family.help, false) << "\n";
+        out << "# TYPE " << family.name << " " << type << "\n";
+        for (const auto& series : family.series) {
+            if (series.counter) {
+                out << family.name << prometheus_labels(series.labels) << " " << series.counter->value() << "\n";
+            } else if (series.gauge) {
+                out << family.name << prometheus_labels(series.labels) << " "
+                    << format_number(series.gauge->value()) << "\n";
+            } else if (series.histogram) {
+                const Histogram& h = *series.histogram;
+                std::vector<uint64_t> counts = h.cumulative_counts();
+                for (size_t i = 0; i < counts.size(); ++i) {
+                    std::string le = i < h.bounds().size() ? format_number(h.bounds()[i]) : "+Inf";
+                    out << family.name << "_bucket" << prometheus_labels(series.labels, "le=\"" + le + "\"")
+                        << " " << counts[i] << "\n";
+                }
+                out << family.name << "_sum" << prometheus_labels(series.labels) << " "
+                    << format_number(h.sum_seconds()) << "\n";
+                out << family.name << "_count" << prometheus_labels(series.labels) << " " << counts.back() << "\n";
+            }
+        }
+    }
+}
+
+void MetricsRegistry::write_json(std::ostream& out) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    out << "{\"elapsed_seconds\":" << format_json_number(elapsed_seconds()) << ",\"metrics\":{";
+    for (size_t f = 0; f < families.size(); ++f) {
+        const Family& family = families[f];
+        const char* type = family.type == Type::COUNTER ? "counter"
+                         : family.type == Type::GAUGE ? "gauge" : "histogram";
+        if (f) out << ",";
+        out << "\"" << escape(family.name, true) << "\":{\"type\":\"" << type
+            << "\",\"help\":\"" << escape(family.help, true) << "\",\"series\":[";
+        for (size_t s = 0; s < family.series.size(); ++s) {
+            const Series& series = family.series[s];
+            if (s) out << ",";
+            out << "{\"labels\":" << json_labels(series.labels);
+            if (series.counter) {
+                out << ",\"value\":" << series.counter->value();
+            } else if (series.gauge) {
+                out << ",\"value\":" << format_json_number(series.gauge->value());
+            } else if (series.histogram) {
+                const Histogram& h = *series.histogram;
+                out << ",\"count\":" << h.count()
+                    << ",\"sum\":" << format_json_number(h.sum_seconds())
+                    << ",\"p50\":" << format_json_number(h.quantile(0.5))
+                    << ",\"p90\":" << format_json_number(h.quantile(0.9))
+                    << ",\"p99\":" << format_json_number(h.quantile(0.99));
+            }
+            out << "}";
+        }
+        out << "]}";
+    }
+    out << "}}\n";
+}
+
+bool MetricsRegistry::write_file(const std::string& file_path, bool json, std::string& error) const {
+    // scrapers must never see a half-written file
+    std::string tmp_path = file_path + ".tmp";
+    {
+        std::ofstream out(tmp_path, std::ios::trunc);
+        if (!out) {
+            error = "cannot write metrics '" + tmp_path + "'";
+            return false;
+        }
+        if (json) {
+            write_json(out);
+        } else {
+            write_prometheus(out);
+        }
+        out.flush();
+        if (!out) {
+            error = "failed while writing metrics '" + tmp_path + "'";
+            return false;
+        }
+    }
+    if (std::rename(tmp_path.c_str(), file_path.c_str()) != 0) {
+        error = "cannot replace metrics '" + file_path + "'";
+        std::remove(tmp_path.c_str());
+        return false;
+    }
+    return true;
+}
+
+MetricsExporter::MetricsExporter(const MetricsRegistry& registry_, std::string file_path_,
+                                 std::chrono::milliseconds interval_, RefreshCallback refresh_)
+    : registry(registry_), file_path(std::move(file_path_)), interval(interval_), refresh(std::move(refresh_))
+{
+    if (interval.count() > 0) {
+        thread = std::thread([this] { run(); });
+    }
+}
+
+MetricsExporter::~MetricsExporter() {
+    std::string error;
+    stop(error);
+}
+
+bool MetricsExporter::stop(std::string& error) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (stopping) return true;
+        stopping = true;
+    }
+    wake.notify_all();
+    if (thread.joinable()) thread.join();
+    return export_once(error);
+}
+
+void MetricsExporter::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!wake.wait_for(lock, interval, [this] { return stopping; })) {
+        lock.unlock();
+        std::string error;
+        export_once(error);  // a failed periodic write is retried on the next tick
+        lock.lock();
+    }
+}
+
+bool MetricsExporter::export_once(std::string& error) {
+    if (refresh) refresh();
+    return registry.write_file(file_path, false, error);
+}
@@ -0,0 +1,252 @@
+/**
+ * @file options.cpp
+ * @brief Command-line argument parsing for the secret scanner CLI.
+ *
+ * Accepts an optional positional directory plus long flags written either as
+ * "--flag=value" or "--flag value". Repeatable flags such as --include and --exclude
+ * accumulate into lists. A leading "merge" selects the merge subcommand, whose positional
+ * arguments are shard partial results.
+ *
+ * @author Dorna Raj Gyawali <dronarajgyawali@gmail.com>
+ * @date 2025
+ */
+
+#include "options.h"
+#include "engine.h"
+#include "resources.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+
+// splits "--name=value" into name and value; "--name value" takes the next argument
+bool take_flag(const std::string& arg, const std::string& name, int& i, int argc, char* argv[],
+               std::string& value) {
+    if (arg == name) {
+        if (i + 1 >= argc) {
+            throw std::invalid_argument("missing value for " + name);
+        }
+        value = argv[++i];
+        return true;
+    }
+    if (arg.compare(0, name.size() + 1, name + "=") == 0) {
+        value = arg.substr(name.size() + 1);
+        return true;
+    }
+    return false;
+}
+
+unsigned long long parse_number(const std::string& name, const std::string& value) {
+    size_t used = 0;
+    unsigned long long number = 0;
+    try {
+        number = std::stoull(value, &used);
+    } catch (const std::exception&) {
+        used = 0;
+    }
+    if (value.empty() || used != value.size() || value[0] == '-') {
+        throw std::invalid_argument("invalid value '" + value + "' for " + name);
+    }
+    return number;
+}
+
+} // namespace
+
+ScanOptions parse_options(int argc, char* argv[]) {
+    ScanOptions options;
+    bool have_directory = false;
+    int first = 1;
+    if (argc > 1 && std::string(argv[1]) == "merge") {
+        options.merge = true;
+        first = 2;
+    }
+
+    for (int i = first; i < argc; ++i) {
+        std::string arg = argv[i];
+        std::string value;
+
+        if (arg == "--help" || arg == "-h") {
+            options.show_help = true;
+        } else if (take_flag(arg, "--include", i, argc, argv, value)) {
+            options.include_globs.push_back(value);
+        } else if (take_flag(arg, "--exclude", i, argc, argv, value)) {
+            options.exclude_globs.push_back(value);
+        } else if (take_flag(arg, "--max-line-length", i, argc, argv, value)) {
+            options.max_line_length = parse_number("--max-line-length", value);
+        } else if (take_flag(arg, "--file-budget-ms", i, argc, argv, value)) {
+            options.file_budget_ms = static_cast<long long>(parse_number("--file-budget-ms", value));
+        } else if (take_flag(arg, "--baseline", i, argc, argv, value)) {
+            options.baseline_path = value;
+        } else if (take_flag(arg, "--write-baseline", i, argc, argv, value)) {
+            options.write_baseline_path = value;
+        } else if (take_flag(arg, "--shard", i, argc, argv, value)) {
+            options.shard = parse_shard_spec(value);
+        } else if (take_flag(arg, "--partial-out", i, argc, argv, value)) {
+            options.partial_output = value;
+        } else if (take_flag(arg, "--batch", i, argc, argv, value)) {
+            options.batch_manifest = value;
+        } else if (take_flag(arg, "--files-from", i, argc, argv, value)) {
+            options.files_from = value;
+        } else if (arg == "--apply-filters") {
+            options.apply_filters = true;
+        } else if (arg == "--stream") {
+            options.stream = true;
+        } else if (arg == "--redact") {
+            options.redact = true;
+        } else if (arg == "--watch") {
+            options.watch = true;
+        } else if (arg == "--update-baseline") {
+            options.update_baseline = true;
+        } else if (take_flag(arg, "--metrics-file", i, argc, argv, value)) {
+            options.metrics_file = value;
+        } else if (take_flag(arg, "--metrics-json", i, argc, argv, value)) {
+            options.metrics_json_path = value;
+        } else if (take_flag(arg, "--metrics-interval", i, argc, argv, value)) {
+            options.metrics_interval = parse_number("--metrics-interval", value);
+        } else if (take_flag(arg, "--readers", i, argc, argv, value)) {
+            options.readers = parse_number("--readers", value);
+        } else if (take_flag(arg, "--matchers", i, argc, argv, value)) {
+            options.matchers = parse_number("--matchers", value);
+        } else if (arg == "--prioritize") {
+            options.prioritize = true;
+        } else if (arg == "--fail-fast") {
+            options.max_findings = 1;
+        } else if (take_flag(arg, "--max-findings", i, argc, argv, value)) {
+            options.max_findings = parse_number("--max-findings", value);
+            if (options.max_findings == 0) {
+                throw std::invalid_argument("--max-findings must be at least 1");
+            }
+        } else if (take_flag(arg, "--trace", i, argc, argv, value)) {
+            options.trace_path = value;
+        } else if (arg == "--trace-rules") {
+            options.trace_rules = true;
+        } else if (arg == "--decode") {
+            if (options.decode_depth == 0) options.decode_depth = 2;
+        } else if (take_flag(arg, "--decode-depth", i, argc, argv, value)) {
+            options.decode_depth = parse_number("--decode-depth", value);
+        } else if (take_flag(arg, "--memory-budget", i, argc, argv, value)) {
+            uint64_t bytes = 0;
+            if (!parse_byte_size(value, bytes)) {
+                throw std::invalid_argument("invalid value '" + value + "' for --memory-budget");
+            }
+            options.memory_budget = bytes;
+        } else if (arg == "--low-priority") {
+            options.low_priority = true;
+        } else if (arg == "--group") {
+            options.group = true;
+        } else if (take_flag(arg, "--max-locations", i, argc, argv, value)) {
+            options.max_locations = parse_number("--max-locations", value);
+        } else if (take_flag(arg, "--results-memory", i, argc, argv, value)) {
+            uint64_t bytes = 0;
+            if (!parse_byte_size(value, bytes)) {
+                throw std::invalid_argument("invalid value '" + value + "' for --results-memory");
+            }
+            options.results_memory = bytes;
+        } else if (take_flag(arg, "--engine", i, argc, argv, value)) {
+            std::vector<std::string> engines = available_engines();
+            if (std::find(engines.begin(), engines.end(), value) == engines.end()) {
+                std::string names;
+                for (const auto& name : engines) names += (names.empty() ? "" : ", ") + name;
+                throw std::invalid_argument("unknown or unavailable engine '" + value + "' (this build has " +
+                                            names + ")");
+            }
+            options.engine = value;
+        } else if (arg.size() > 1 && arg[0] == '-') {
+            throw std::invalid_argument("unknown option '" + arg + "'");
+        } else if (options.merge) {
+            options.merge_inputs.push_back(arg);
+        } else if (!have_directory) {
+            options.directory = arg;
+            have_directory = true;
+        } else {
+            throw std::invalid_argument("unexpected argument '" + arg + "'");
+        }
+    }
+    if (options.merge && options.merge_inputs.empty()) {
+        throw std::invalid_argument("merge needs at least one partial result");
+    }
+    if (options.shard.enabled()) {
+        if (!options.batch_manifest.empty()) {
+            throw std::invalid_argument("--shard cannot be combined with --batch");
+        }
+        if (!options.write_baseline_path.empty() || options.update_baseline) {
+            throw std::invalid_argument("a shard only sees part of the findings and cannot write a baseline");
+        }
+    }
+    if (options.watch) {
+        if (options.merge || options.shard.enabled() || !options.batch_manifest.empty()) {
+            throw std::invalid_argument("--watch scans one directory and cannot be combined with merge, "
+                                        "--shard or --batch");
+        }
+        if (!options.write_baseline_path.empty() || options.update_baseline) {
+            throw std::invalid_argument("--watch cannot write a baseline");
+        }
+    }
+    if (options.trace_rules && options.trace_path.empty()) {
+        throw std::invalid_argument("--trace-rules requires --trace");
+    }
+    if (!options.trace_path.empty() && (options.watch || options.merge)) {
+        throw std::invalid_argument("--trace records a scan that ends and cannot be combined with --watch or merge");
+    }
+    if (options.redact && !options.stream) {
+        throw std::invalid_argument("--redact requires --stream");
+    }
+    if (options.stream) {
+        if (options.merge || options.watch || options.shard.enabled() || !options.batch_manifest.empty() ||
+            options.max_findings || options.prioritize) {
+            throw std::invalid_argument("--stream reads one input and cannot be combined with merge, --watch, "
+                                        "--shard, --batch, --prioritize or --max-findings");
+        }
+        if (!options.baseline_path.empty() || !options.write_baseline_path.empty() || options.update_baseline) {
+            throw std::invalid_argument("baselines are not supported with --stream");
+        }
+        if (options.decode_depth) {
+            throw std::invalid_argument("--decode only applies to files read whole and cannot be combined with --stream");
+        }
+    }
+    if (options.max_findings) {
+        // stopping early is only useful when the scan runs in risk order
+        options.prioritize = true;
+        if (!options.write_baseline_path.empty() || options.update_baseline) {
+            throw std::invalid_argument("--fail-fast and --max-findings stop early and cannot write a baseline");
+        }
+    }
+    if (options.prioritize && (options.merge || options.watch || options.shard.enabled() ||
+                               !options.batch_manifest.empty())) {
+        throw std::invalid_argument("--prioritize, --fail-fast and --max-findings only apply to a single "
+                                    "directory scan");
+    }
+    if (!options.batch_manifest.empty()) {
+        if (have_directory) {
+            throw std::invalid_argument("--batch takes its directories from the manifest");
+        }
+        if (!options.baseline_path.empty() || !options.write_baseline_path.empty() || options.update_baseline) {
+            throw std::invalid_argument("baselines are not supported with --batch");
+        }
+    }
+    if (options.group && (options.watch || options.stream || options.shard.enabled() ||
+                          !options.batch_manifest.empty())) {
+        throw std::invalid_argument("--group applies to the final report and cannot be combined with --watch, "
+                                    "--stream, --shard or --batch");
+    }
+    if (options.apply_filters && options.files_from.empty()) {
+        throw std::invalid_argument("--apply-filters requires --files-from");
+    }
+    if (!options.files_from.empty() && (options.merge || options.watch || options.stream ||
+                                        !options.batch_manifest.empty())) {
+        throw std::invalid_argument("--files-from replaces the directory walk and cannot be combined with merge, "
+                                    "--watch, --stream or --batch");
+    }
+    if (!options.files_from.empty() && (!options.write_baseline_path.empty() || options.update_baseline)) {
+        throw std::invalid_argument("a file list only sees part of the findings and cannot write a baseline");
+    }
+    if (options.update_baseline) {
+        if (options.baseline_path.empty()) {
+            throw std::invalid_argument("--update-baseline requires --baseline");
+        }
+        if (options.write_baseline_path.empty()) {
+            options.write_baseline_path = options.baseline_path;
+        }
+    }
+    return options;
+}
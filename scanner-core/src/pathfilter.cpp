@@ -0,0 +1,285 @@
+/**
+ * @file pathfilter.cpp
+ * @brief Implements the PathFilter class for compiled include/exclude glob matching.
+ *
+ * This file contains the implementation of the PathFilter, which compiles any number of
+ * .gitignore-style glob patterns into one trie of path components. Matching walks the trie with
+ * a set of active states (an NFA over components), so each path is evaluated in a single pass
+ * over its components instead of testing every pattern in turn.
+ *
+ * Features:
+ * - Literal components resolved with one hash lookup per active state.
+ * - '*', '?', '[...]' wildcards within a component and "**" across components.
+ * - Anchored ('/foo'), floating ('foo') and directory-only ('foo/') patterns.
+ * - Loading of per-repository ignore files.
+ *
+ * @author Dorna Raj Gyawali <dronarajgyawali@gmail.com>
+ * @date 2025
+ */
+
+#include "pathfilter.h"
+#include <fstream>
+#include <algorithm>
+
+namespace {
+
+bool has_wildcard(const std::string& component) {
+    return component.find_first_of("*?[\\") != std::string::npos;
+}
+
+// matches c against the bracket expression starting at pat[p]; advances p past it on success
+bool match_class(const std::string& pat, size_t& p, char c) {
+    size_t i = p + 1;
+    bool negate = false;
+    if (i < pat.size() && (pat[i] == '!' || pat[i] == '^')) {
+        negate = true;
+        ++i;
+    }
+    bool matched = false;
+    bool first = true;
+    while (i < pat.size() && (first || pat[i] != ']')) {
+        first = false;
+        char lo = pat[i];
+        if (lo == '\\' && i + 1 < pat.size()) lo = pat[++i];
+        char hi = lo;
+        if (i + 2 < pat.size() && pat[i + 1] == '-' && pat[i + 2] != ']') {
+            hi = pat[i + 2];
+            i += 2;
+        }
+        if (lo <= c && c <= hi) matched = true;
+        ++i;
+    }
+    if (i >= pat.size()) {
+        // unterminated bracket, treat '[' as a literal character
+        if (c != '[') return false;
+        p += 1;
+        return true;
+    }
+    p = i + 1;
+    return matched != negate;
+}
+
+} // namespace
+
+bool PathFilter::ComponentGlob::matches(std::string_view s) const {
+    const std::string& pat = pattern;
+    size_t p = 0, i = 0;
+    size_t star_p = std::string::npos, star_i = 0;
+
+    while (i < s.size()) {
+        if (p < pat.size()) {
+            char pc = pat[p];
+            if (pc == '*') {
+                star_p = ++p;
+                star_i = i;
+                continue;
+            }
+            if (pc == '?') {
+                ++p;
+                ++i;
+                continue;
+            }
+            if (pc == '[') {
+                size_t q = p;
+                if (match_class(pat, q, s[i])) {
+                    p = q;
+                    ++i;
+                    continue;
+                }
+            } else {
+                size_t step = 1;
+                if (pc == '\\' && p + 1 < pat.size()) {
+                    pc = pat[p + 1];
+                    step = 2;
+                }
+                if (pc == s[i]) {
+                    p += step;
+                    ++i;
+                    continue;
+                }
+            }
+        }
+        if (star_p != std::string::npos) {
+            // backtrack: let the last '*' swallow one more character
+            p = star_p;
+            i = ++star_i;
+            continue;
+        }
+        return false;
+    }
+    while (p < pat.size() && pat[p] == '*') ++p;
+    return p == pat.size();
+}
+
+PathFilter::PathFilter() : nodes(1) {}
+
+PathFilter PathFilter::from_ignored_dirs(const std::unordered_set<std::string>& ignored_dirs) {
+    PathFilter filter;
+    for (const auto& d : ignored_dirs) {
+        filter.add_exclude(d + "/");
+    }
+    return filter;
+}
+
+void PathFilter::add_include(const std::string& glob) {
+    add_pattern(glob, INCLUDE);
+}
+
+void PathFilter::add_exclude(const std::string& glob) {
+    add_pattern(glob, EXCLUDE);
+}
+
+bool PathFilter::load_ignore_file(const std::string& file_path) {
+    std::ifstream file(file_path);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    std::string line;
+    while (std::getline(file, line)) {
+        while (!line.empty() && (line.back() == '\r' || line.back() == ' ' || line.back() == '\t')) {
+            line.pop_back();
+        }
+        if (line.empty() || line[0] == '#') continue;
+        if (line[0] == '!') {
+            add_include(line.substr(1));
+        } else {
+            add_exclude(line);
+        }
+    }
+    return true;
+}
+
+void PathFilter::add_pattern(const std::string& glob, uint8_t kind) {
+    std::string pattern = glob;
+    if (pattern.compare(0, 2, "./") == 0) pattern.erase(0, 2);
+
+    bool dir_only = false;
+    while (!pattern.empty() && pattern.back() == '/') {
+        dir_only = true;
+        pattern.pop_back();
+    }
+    bool anchored = false;
+    if (!pattern.empty() && pattern[0] == '/') {
+        anchored = true;
+        pattern.erase(0, 1);
+    }
+    if (pattern.empty()) return;
+    // like .gitignore, a separator in the middle anchors the pattern to the root
+    if (pattern.find('/') != std::string::npos) anchored = true;
+
+    std::vector<std::string> components;
+    if (!anchored) components.push_back("**");
+    size_t start = 0;
+    while (start <= pattern.size()) {
+        size_t end = pattern.find('/', start);
+        if (end == std::string::npos) end = pattern.size();
+        std::string component = pattern.substr(start, end - start);
+        if (!component.empty() && component != "." &&
+            !(component == "**" && !components.empty() && components.back() == "**")) {
+            components.push_back(std::move(component));
+        }
+        start = end + 1;
+    }
+
+    uint32_t node = 0;
+    for (const auto& component : components) {
+        node = child_for(node, component);
+    }
+    if (dir_only) {
+        nodes[node].accept_dir |= kind;
+    } else {
+        nodes[node].accept_any |= kind;
+    }
+    pattern_count++;
+}
+
+uint32_t PathFilter::child_for(uint32_t parent, const std::string& component) {
+    if (component == "**") {
+        if (nodes[parent].globstar_child == NONE) {
+            uint32_t id = static_cast<uint32_t>(nodes.size());
+            nodes.emplace_back();
+            nodes[id].is_globstar = true;
+            nodes[parent].globstar_child = id;
+        }
+        return nodes[parent].globstar_child;
+    }
+
+    if (!has_wildcard(component)) {
+        auto it = nodes[parent].literal_children.find(component);
+        if (it != nodes[parent].literal_children.end()) return it->second;
+        uint32_t id = static_cast<uint32_t>(nodes.size());
+        nodes.emplace_back();
+        nodes[parent].literal_children.emplace(component, id);
+        return id;
+    }
+
+    for (const auto& [glob, child] : nodes[parent].glob_children) {
+        if (glob.pattern == component) return child;
+    }
+    uint32_t id = static_cast<uint32_t>(nodes.size());
+    nodes.emplace_back();
+    nodes[parent].glob_children.push_back({ComponentGlob{component}, id});
+    return id;
+}
+
+void PathFilter::add_closure(uint32_t state, std::vector<uint32_t>& states) const {
+    if (std::find(states.begin(), states.end(), state) != states.end()) return;
+    states.push_back(state);
+    // "**" may match zero components, so its continuation is active right away
+    if (nodes[state].globstar_child != NONE) {
+        add_closure(nodes[state].globstar_child, states);
+    }
+}
+
+PathFilter::Match PathFilter::match(std::string_view rel_path, bool is_dir) const {
+    Match result;
+    if (pattern_count == 0) return result;
+
+    std::vector<uint32_t> current;
+    std::vector<uint32_t> next;
+    std::string key;
+    add_closure(0, current);
+
+    size_t start = 0;
+    while (start < rel_path.size() && !current.empty()) {
+        size_t end = rel_path.find('/', start);
+        if (end == std::string_view::npos) end = rel_path.size();
+        std::string_view component = rel_path.substr(start, end - start);
+        start = end + 1;
+        if (component.empty() || component == ".") continue;
+
+        next.clear();
+        key.assign(component.data(), component.size());
+        for (uint32_t s : current) {
+            const Node& node = nodes[s];
+            if (node.is_globstar) add_closure(s, next);
+            auto it = node.literal_children.find(key);
+            if (it != node.literal_children.end()) add_closure(it->second, next);
+            for (const auto& [glob, child] : node.glob_children) {
+                if (glob.matches(component)) add_closure(child, next);
+            }
+        }
+
+        // every component but the last one is a directory
+        bool last = start >= rel_path.size();
+        bool as_dir = !last || is_dir;
+        for (uint32_t s : next) {
+            uint8_t flags = nodes[s].accept_any | (as_dir ? nodes[s].accept_dir : 0);
+            if (flags & INCLUDE) result.included = true;
+            if (flags & EXCLUDE) result.excluded = true;
+        }
+        if (result.excluded && result.included) break;
+        current.swap(next);
+    }
+    return result;
+}
+
+bool PathFilter::is_excluded_dir(std::string_view rel_path) const {
+    return match(rel_path, true).excluded;
+}
+
+bool PathFilter::selects_file(std::string_view rel_path, bool has_valid_extension) const {
+    Match m = match(rel_path, false);
+    return !m.excluded && (has_valid_extension || m.included);
+}
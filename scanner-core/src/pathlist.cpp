@@ -0,0 +1,84 @@
+/**
+ * @file pathlist.cpp
+ * @brief Incremental splitting of NUL- or newline-separated path lists.
+ *
+ * Lets a scan take its files from another tool, such as git ls-files -z or
+ * find -print0, instead of walking a tree. The list is split as it is read, so the
+ * first files are scanned while the producer is still writing the rest.
+ *
+ * Features:
+ * - NUL or newline separators, detected from the first one in the list.
+ * - Paths split across read boundaries are reassembled.
+ * - CRLF line endings and empty entries are tolerated.
+ * - Root-relative paths that leave files outside the root as they are.
+ *
+ * @author Dorna Raj Gyawali <dronarajgyawali@gmail.com>
+ * @date 2025
+ */
+
+#include "pathlist.h"
+#include <cerrno>
+#include <vector>
+#include <unistd.h>
+
+void PathListSplitter::feed(std::string_view data, const PathCallback& on_path) {
+    if (separator == Separator::detect) {
+        size_t first = data.find_first_of(std::string_view("\0\n", 2));
+        if (first == std::string_view::npos) {
+            partial.append(data.data(), data.size());
+            return;
+        }
+        separator = data[first] == '\0' ? Separator::nul : Separator::newline;
+    }
+
+    const char delimiter = separator == Separator::nul ? '\0' : '\n';
+    size_t start = 0;
+    while (true) {
+        size_t end = data.find(delimiter, start);
+        if (end == std::string_view::npos) break;
+        if (partial.empty()) {
+            emit(data.substr(start, end - start), on_path);
+        } else {
+            partial.append(data.data() + start, end - start);
+            emit(partial, on_path);
+            partial.clear();
+        }
+        start = end + 1;
+    }
+    partial.append(data.data() + start, data.size() - start);
+}
+
+void PathListSplitter::finish(const PathCallback& on_path) {
+    if (separator == Separator::detect) separator = Separator::newline;
+    emit(partial, on_path);
+    partial.clear();
+}
+
+void PathListSplitter::emit(std::string_view path, const PathCallback& on_path) const {
+    if (separator == Separator::newline && !path.empty() && path.back() == '\r') path.remove_suffix(1);
+    if (!path.empty()) on_path(path);
+}
+
+bool read_path_list(int fd, const PathListSplitter::PathCallback& on_path, PathListSplitter::Separator separator) {
+    PathListSplitter splitter(separator);
+    std::vector<char> buffer(64 * 1024);
+    while (true) {
+        ssize_t got = read(fd, buffer.data(), buffer.size());
+        if (got < 0 && errno == EINTR) continue;
+        if (got < 0) return false;
+        if (got == 0) break;
+        splitter.feed(std::string_view(buffer.data(), static_cast<size_t>(got)), on_path);
+    }
+    splitter.finish(on_path);
+    return true;
+}
+
+size_t root_relative_offset(std::string_view path, std::string_view root) {
+    while (root.size() > 1 && root.back() == '/') root.remove_suffix(1);
+    if (root.empty()) return 0;
+    if (root == "/") return path.size() > 1 && path.front() == '/' ? 1 : 0;
+    if (path.size() > root.size() + 1 && path.compare(0, root.size(), root) == 0 && path[root.size()] == '/') {
+        return root.size() + 1;
+    }
+    return 0;
+}
@@ -0,0 +1,320 @@
+/**
+ * @file pipeline.cpp
+ * @brief Implements the ScanPipeline class, a bounded multi-stage scanning pipeline.
+ *
+ * This file contains the implementation of the ScanPipeline, which separates reading files
+ * from matching them. Stages are connected by fixed-capacity queues so that a slow stage
+ * applies backpressure to the one before it instead of letting work pile up in memory.
+ *
+ * Features:
+ * - Bounded path and buffer queues between stages.
+ * - Independent reader and matcher thread counts.
+ * - Completion tracked by counters instead of one future per file.
+ * - Optional per-stage latency, queue depth and byte metrics.
+ * - Per-file scanners so one set of threads can serve many scan roots.
+ * - Files above the stream threshold are streamed by the matcher instead of read whole.
+ * - Optional adaptive reader and matcher counts driven by a controller thread.
+ * - Cancellation that drops queued files, for early exit once the answer is known.
+ * - Read and match spans per file when a TraceRecorder is active.
+ * - Optional memory budget for file buffers; default thread counts follow cgroup CPU limits.
+ *
+ * @author Dorna Raj Gyawali <dronarajgyawali@gmail.com>
+ * @date 2025
+ */
+
+#include "pipeline.h"
+#include "trace.h"
+#include <algorithm>
+#include <fstream>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+size_t default_matchers(size_t requested) {
+    if (requested) return requested;
+    return available_cpus();
+}
+
+size_t default_max_readers(size_t requested) {
+    if (requested) return requested;
+    return std::clamp<size_t>(4 * available_cpus(), 4, 64);
+}
+
+uint64_t elapsed_ns(Clock::time_point since, Clock::time_point until) {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(until - since).count());
+}
+
+} // namespace
+
+ScanPipeline::ScanPipeline(const SecretScanner& scanner_, PipelineConfig config, FileCallback on_file_done_)
+    : scanner(scanner_),
+      on_file_done(std::move(on_file_done_)),
+      memory(config.memory),
+      paths(config.path_capacity),
+      buffers(config.buffer_capacity ? config.buffer_capacity
+                                      : 2 * default_matchers(config.adaptive ? config.max_matchers : config.matchers))
+{
+    size_t readers = std::max<size_t>(1, config.readers);
+    size_t matchers = default_matchers(config.matchers);
+    size_t reader_threads_count = readers;
+    size_t matcher_threads_count = matchers;
+    ConcurrencyLimits limits;
+    if (config.adaptive) {
+        limits.max_readers = std::max(readers, default_max_readers(config.max_readers));
+        limits.max_matchers = default_matchers(config.max_matchers);
+        matchers = std::min(matchers, limits.max_matchers);
+        reader_threads_count = limits.max_readers;
+        matcher_threads_count = limits.max_matchers;
+    }
+
+    if (MetricsRegistry* metrics = config.metrics) {
+        const std::string stage_help = "Time spent per file in each pipeline stage";
+        instruments.files_scanned = &metrics->counter("scanner_files_scanned_total", "Files read and matched");
+        instruments.files_unreadable = &metrics->counter("scanner_files_unreadable_total", "Files that could not be opened");
+        instruments.bytes_read = &metrics->counter("scanner_bytes_read_total", "Bytes read from scanned files");
+        instruments.read_latency = &metrics->histogram("scanner_stage_duration_seconds", stage_help, {{"stage", "read"}});
+        instruments.queue_wait = &metrics->histogram("scanner_stage_duration_seconds", stage_help, {{"stage", "queue"}});
+        instruments.match_latency = &metrics->histogram("scanner_stage_duration_seconds", stage_help, {{"stage", "match"}});
+        const std::string depth_help = "Items waiting in a pipeline queue";
+        instruments.path_depth = &metrics->gauge("scanner_queue_depth", depth_help, {{"queue", "paths"}});
+        instruments.buffer_depth = &metrics->gauge("scanner_queue_depth", depth_help, {{"queue", "buffers"}});
+        const std::string capacity_help = "Capacity of a pipeline queue";
+        metrics->gauge("scanner_queue_capacity", capacity_help, {{"queue", "paths"}}).set(static_cast<double>(paths.max_size()));
+        metrics->gauge("scanner_queue_capacity", capacity_help, {{"queue", "buffers"}}).set(static_cast<double>(buffers.max_size()));
+        const std::string workers_help = "Worker threads per pipeline stage";
+        reader_gauge = &metrics->gauge("scanner_workers", workers_help, {{"stage", "read"}});
+        matcher_gauge = &metrics->gauge("scanner_workers", workers_help, {{"stage", "match"}});
+        if (memory) {
+            metrics->gauge("scanner_memory_budget_bytes", "Bytes file buffers and results may hold (0 = unlimited)")
+                .set(static_cast<double>(memory->limit()));
+            const std::string memory_help = "Bytes held against the memory budget";
+            instruments.buffer_memory = &metrics->gauge("scanner_memory_in_use_bytes", memory_help, {{"kind", "buffers"}});
+            instruments.result_memory = &metrics->gauge("scanner_memory_in_use_bytes", memory_help, {{"kind", "results"}});
+        }
+    }
+
+    set_active(readers, matchers);
+    readers_running = reader_threads_count;
+    for (size_t i = 0; i < reader_threads_count; ++i) {
+        reader_threads.emplace_back([this, i] { reader_loop(i); });
+    }
+    for (size_t i = 0; i < matcher_threads_count; ++i) {
+        matcher_threads.emplace_back([this, i] { matcher_loop(i); });
+    }
+    if (config.adaptive) {
+        controller_thread = std::thread(&ScanPipeline::control_loop, this,
+                                        ConcurrencyController(limits, readers, matchers), config.control_interval);
+    }
+}
+
+ScanPipeline::~ScanPipeline() {
+    finish();
+}
+
+bool ScanPipeline::submit(std::string file_path) {
+    return submit(std::move(file_path), scanner);
+}
+
+bool ScanPipeline::submit(std::string file_path, const SecretScanner& job_scanner) {
+    submitted++;
+    if (cancel_requested.load()) {
+        drop();
+        return false;
+    }
+    if (!paths.push(Job{std::move(file_path), &job_scanner})) {
+        // pipeline already finished; count the file so the totals stay balanced
+        completed++;
+    }
+    return true;
+}
+
+void ScanPipeline::cancel() {
+    cancel_requested = true;
+}
+
+void ScanPipeline::finish() {
+    if (finished) return;
+    finished = true;
+
+    {
+        std::lock_guard<std::mutex> lock(controller_mutex);
+        controller_stop = true;
+    }
+    controller_cv.notify_all();
+    if (controller_thread.joinable()) controller_thread.join();
+
+    // parked readers wake up and help drain what is left
+    {
+        std::lock_guard<std::mutex> lock(park_mutex);
+        readers_closing = true;
+    }
+    park_cv.notify_all();
+    paths.close();
+    for (auto& t : reader_threads) t.join();
+    for (auto& t : matcher_threads) t.join();
+}
+
+void ScanPipeline::wait_until_active(size_t index, const std::atomic<size_t>& active, const bool& closing) {
+    if (index < active.load()) return;
+    std::unique_lock<std::mutex> lock(park_mutex);
+    park_cv.wait(lock, [&] { return index < active.load() || closing; });
+}
+
+void ScanPipeline::set_active(size_t readers, size_t matchers) {
+    {
+        std::lock_guard<std::mutex> lock(park_mutex);
+        readers_active = readers;
+        matchers_active = matchers;
+    }
+    park_cv.notify_all();
+    if (reader_gauge) reader_gauge->set(static_cast<double>(readers));
+    if (matcher_gauge) matcher_gauge->set(static_cast<double>(matchers));
+}
+
+void ScanPipeline::control_loop(ConcurrencyController controller, std::chrono::milliseconds interval) {
+    uint64_t last_files = 0, last_bytes = 0, last_read_ns = 0, last_match_ns = 0;
+    Clock::time_point last = Clock::now();
+    std::unique_lock<std::mutex> lock(controller_mutex);
+    while (!controller_cv.wait_for(lock, interval, [this] { return controller_stop; })) {
+        Clock::time_point now = Clock::now();
+        StageSample sample;
+        sample.seconds = std::chrono::duration<double>(now - last).count();
+        sample.files_read = files_read.load() - last_files;
+        sample.bytes_read = bytes_read.load() - last_bytes;
+        sample.read_busy = static_cast<double>(read_busy_ns.load() - last_read_ns) / 1e9;
+        sample.match_busy = static_cast<double>(match_busy_ns.load() - last_match_ns) / 1e9;
+        sample.path_depth = paths.size();
+        sample.buffer_depth = buffers.size();
+        sample.buffer_capacity = buffers.max_size();
+        last = now;
+        last_files += sample.files_read;
+        last_bytes += sample.bytes_read;
+        last_read_ns += static_cast<uint64_t>(sample.read_busy * 1e9 + 0.5);
+        last_match_ns += static_cast<uint64_t>(sample.match_busy * 1e9 + 0.5);
+
+        controller.update(sample);
+        if (controller.readers() != readers_active.load() || controller.matchers() != matchers_active.load()) {
+            set_active(controller.readers(), controller.matchers());
+        }
+    }
+}
+
+void ScanPipeline::sample_metrics() {
+    if (instruments.path_depth) instruments.path_depth->set(static_cast<double>(paths.size()));
+    if (instruments.buffer_depth) instruments.buffer_depth->set(static_cast<double>(buffers.size()));
+    if (instruments.buffer_memory) {
+        instruments.buffer_memory->set(static_cast<double>(memory->buffer_bytes()));
+        instruments.result_memory->set(static_cast<double>(memory->result_bytes()));
+    }
+}
+
+void ScanPipeline::reader_loop(size_t index) {
+    TraceRecorder::name_thread("reader " + std::to_string(index));
+    Job job;
+    while (true) {
+        wait_until_active(index, readers_active, readers_closing);
+        if (!paths.pop(job)) break;
+        if (cancel_requested.load()) {
+            drop();
+            continue;
+        }
+        FileBuffer buffer;
+        Clock::time_point started = Clock::now();
+        uint64_t size = 0;
+        bool ok = false;
+        {
+            TraceSpan span("io", "read", job.path);
+            buffer.stream = job.scanner->should_stream(job.path, &size);
+            if (memory) {
+                const ScanLimits& limits = job.scanner->get_limits();
+                if (memory->limit() && size > memory->limit()) buffer.stream = true;
+                buffer.reserved = buffer.stream ? 2 * limits.stream_window + limits.block_span : size;
+                // waiting for memory is not read time; the controller would add readers for it
+                Clock::time_point waiting = Clock::now();
+                memory->acquire(buffer.reserved);
+                started += Clock::now() - waiting;
+            }
+            ok = buffer.stream || job.scanner->read_file(job.path, buffer.content);
+        }
+        if (!buffer.stream) size = buffer.content.size();
+        buffer.queued = Clock::now();
+        read_busy_ns += elapsed_ns(started, buffer.queued);
+        files_read++;
+        if (!ok) {
+            release(buffer);
+            unreadable++;
+            if (instruments.files_unreadable) instruments.files_unreadable->add();
+            complete(job.path, *job.scanner);
+            continue;
+        }
+        bytes_read += size;
+        if (instruments.read_latency) {
+            instruments.read_latency->observe(buffer.queued - started);
+            instruments.bytes_read->add(size);
+        }
+        buffer.path = std::move(job.path);
+        buffer.scanner = job.scanner;
+        buffers.push(std::move(buffer));
+    }
+    // the last reader out closes the next stage and releases parked matchers
+    if (--readers_running == 0) {
+        {
+            std::lock_guard<std::mutex> lock(park_mutex);
+            matchers_closing = true;
+        }
+        park_cv.notify_all();
+        buffers.close();
+    }
+}
+
+void ScanPipeline::matcher_loop(size_t index) {
+    TraceRecorder::name_thread("matcher " + std::to_string(index));
+    FileBuffer buffer;
+    while (true) {
+        wait_until_active(index, matchers_active, matchers_closing);
+        if (!buffers.pop(buffer)) break;
+        if (cancel_requested.load()) {
+            release(buffer);
+            drop();
+            continue;
+        }
+        Clock::time_point started = Clock::now();
+        {
+            TraceSpan span("match", buffer.stream ? "scan (streamed)" : "scan", buffer.path);
+            if (buffer.stream) {
+                // streamed whether it passed the scanner's threshold or the memory budget's
+                std::ifstream file(buffer.path, std::ios::binary);
+                if (file.is_open()) buffer.scanner->scan_stream(buffer.path, file);
+            } else {
+                buffer.scanner->scan_buffer(buffer.path, buffer.content);
+            }
+        }
+        Clock::time_point done = Clock::now();
+        release(buffer);
+        match_busy_ns += elapsed_ns(started, done);
+        if (instruments.match_latency) {
+            instruments.queue_wait->observe(started - buffer.queued);
+            instruments.match_latency->observe(done - started);
+            instruments.files_scanned->add();
+        }
+        complete(buffer.path, *buffer.scanner);
+    }
+}
+
+void ScanPipeline::complete(const std::string& path, const SecretScanner& job_scanner) {
+    completed++;
+    if (on_file_done) on_file_done(path, job_scanner);
+}
+
+void ScanPipeline::drop() {
+    cancelled_files++;
+    completed++;
+}
+
+void ScanPipeline::release(FileBuffer& buffer) {
+    if (memory) memory->release(buffer.reserved);
+    buffer.reserved = 0;
+    // the reservation covered the contents; hand the memory back along with it
+    std::string().swap(buffer.content);
+}
@@ -0,0 +1,197 @@
+/**
+ * @file report.cpp
+ * @brief Implements finding records and their single-line JSON form.
+ *
+ * Findings are written one JSON object per line, which is what the VS Code extension and
+ * shell pipelines consume. The reader side only needs flat objects, so it is a small
+ * hand-written parser rather than a JSON library dependency.
+ *
+ * Features:
+ * - Deterministic report order independent of thread scheduling.
+ * - JSON escaping of control characters, quotes and backslashes.
+ * - Parsing of flat JSON lines, including \uXXXX escapes.
+ *
+ * @author Dorna Raj Gyawali <dronarajgyawali@gmail.com>
+ * @date 2025
+ */
+
+#include "report.h"
+#include <cstdio>
+#include <sstream>
+#include <tuple>
+
+namespace {
+
+void append_utf8(std::string& out, unsigned code) {
+    if (code < 0x80) {
+        out += static_cast<char>(code);
+    } else if (code < 0x800) {
+        out += static_cast<char>(0xC0 | (code >> 6));
+        out += static_cast<char>(0x80 | (code & 0x3F));
+    } else if (code < 0x10000) {
+        out += static_cast<char>(0xE0 | (code >> 12));
+        out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (code & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (code >> 18));
+        out += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (code & 0x3F));
+    }
+}
+
+class FlatJsonParser {
+public:
+    explicit FlatJsonParser(std::string_view text_) : text(text_) {}
+
+    bool run(JsonFields& fields) {
+        skip_space();
+        if (!take('{')) return false;
+        skip_space();
+        if (take('}')) return at_end();
+        while (true) {
+            std::string key, value;
+            skip_space();
+            if (!string(key)) return false;
+            skip_space();
+            if (!take(':')) return false;
+            skip_space();
+            if (peek() == '"') {
+                if (!string(value)) return false;
+            } else if (!scalar(value)) {
+                return false;
+            }
+            fields[key] = std::move(value);
+            skip_space();
+            if (take('}')) return at_end();
+            if (!take(',')) return false;
+        }
+    }
+
+private:
+    std::string_view text;
+    size_t i = 0;
+
+    char peek() const { return i < text.size() ? text[i] : '\0'; }
+
+    bool take(char c) {
+        if (peek() != c) return false;
+        ++i;
+        return true;
+    }
+
+    void skip_space() {
+        while (i < text.size() && (text[i] == ' ' || text[i] == '\t' || text[i] == '\r' || text[i] == '\n')) ++i;
+    }
+
+    bool at_end() {
+        skip_space();
+        return i == text.size();
+    }
+
+    bool hex4(unsigned& code) {
+        if (i + 4 > text.size()) return false;
+        code = 0;
+        for (int k = 0; k < 4; ++k) {
+            char c = text[i++];
+            code <<= 4;
+            if (c >= '0' && c <= '9') code |= static_cast<unsigned>(c - '0');
+            else if (c >= 'a' && c <= 'f') code |= static_cast<unsigned>(c - 'a' + 10);
+            else if (c >= 'A' && c <= 'F') code |= static_cast<unsigned>(c - 'A' + 10);
+            else return false;
+        }
+        return true;
+    }
+
+    bool string(std::string& out) {
+        if (!take('"')) return false;
+        while (i < text.size()) {
+            char c = text[i++];
+            if (c == '"') return true;
+            if (c != '\\') {
+                out += c;
+                continue;
+            }
+            if (i >= text.size()) return false;
+            char e = text[i++];
+            switch (e) {
+            case '"': out += '"'; break;
+            case '\\': out += '\\'; break;
+            case '/': out += '/'; break;
+            case 'b': out += '\b'; break;
+            case 'f': out += '\f'; break;
+            case 'n': out += '\n'; break;
+            case 'r': out += '\r'; break;
+            case 't': out += '\t'; break;
+            case 'u': {
+                unsigned code = 0;
+                if (!hex4(code)) return false;
+                if (code >= 0xD800 && code < 0xDC00 && text.substr(i, 2) == "\\u") {
+                    i += 2;
+                    unsigned low = 0;
+                    if (!hex4(low)) return false;
+                    code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                }
+                append_utf8(out, code);
+                break;
+            }
+            default:
+                return false;
+            }
+        }
+        return false;
+    }
+
+    bool scalar(std::string& out) {
+        size_t start = i;
+        while (i < text.size() && text[i] != ',' && text[i] != '}' && text[i] != ' ' && text[i] != '\t') ++i;
+        out.assign(text.substr(start, i - start));
+        return !out.empty();
+    }
+};
+
+} // namespace
+
+bool finding_less(const FindingRecord& a, const FindingRecord& b) {
+    return std::tie(a.file, a.offset, a.type, a.match) < std::tie(b.file, b.offset, b.type, b.match);
+}
+
+std::string json_escape(std::string_view s) {
+    std::string out;
+    out.reserve(s.size());
+    for (char c : s) {
+        switch (c) {
+        case '"': out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\n': out += "\\n"; break;
+        case '\r': out += "\\r"; break;
+        case '\t': out += "\\t"; break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                char buf[8];
+                std::snprintf(buf, sizeof(buf), "\\u%04x", static_cast<unsigned char>(c));
+                out += buf;
+            } else {
+                out += c;
+            }
+        }
+    }
+    return out;
+}
+
+std::string finding_to_json(const FindingRecord& finding) {
+    std::ostringstream ss;
+    ss << "{"
+       << R"("file":")" << json_escape(finding.file) << "\","
+       << R"("line":)" << finding.line << ","
+       << R"("column":)" << finding.column << ","
+       << R"("offset":)" << finding.offset << ","
+       << R"("type":")" << json_escape(finding.type) << "\","
+       << R"("match":")" << json_escape(finding.match) << "\""
+       << "}";
+    return ss.str();
+}
+
+bool parse_json_object(std::string_view line, JsonFields& fields) {
+    return FlatJsonParser(line).run(fields);
+}
@@ -0,0 +1,299 @@
+/**
+ * @file resources.cpp
+ * @brief cgroup-aware CPU and memory limits, process priority and the memory budget.
+ *
+ * In a container std::thread::hardware_concurrency() reports the host's CPUs, not the
+ * quota the container is given, so a scanner sized from it runs far more threads than it
+ * may use and gets throttled by the CFS scheduler. The limits are read from the cgroup
+ * file system instead and worker counts are sized from them.
+ *
+ * Features:
+ * - cgroup v2 cpu.max, memory.max and memory.high, and their v1 equivalents.
+ * - Limits of parent cgroups are honored; the tightest one wins.
+ * - CPU affinity (cpusets, taskset) caps the worker count as well.
+ * - Nice value and idle I/O class for scans that should yield to other work.
+ * - Blocking byte budget for file buffers, with results charged against it.
+ *
+ * @author Dorna Raj Gyawali <dronarajgyawali@gmail.com>
+ * @date 2025
+ */
+
+#include "resources.h"
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <vector>
+#include <sys/resource.h>
+
+#if defined(__linux__)
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// cgroup v1 reports "no limit" as LONG_MAX rounded down to a page
+constexpr uint64_t unlimited_v1 = uint64_t{1} << 62;
+
+struct CgroupLine {
+    std::string hierarchy;
+    std::string controllers;
+    std::string path;
+};
+
+std::vector<CgroupLine> read_cgroup_lines(const std::string& proc_cgroup) {
+    std::vector<CgroupLine> lines;
+    std::ifstream in(proc_cgroup);
+    std::string line;
+    while (std::getline(in, line)) {
+        size_t first = line.find(':');
+        size_t second = first == std::string::npos ? first : line.find(':', first + 1);
+        if (second == std::string::npos) continue;
+        lines.push_back({line.substr(0, first), line.substr(first + 1, second - first - 1), line.substr(second + 1)});
+    }
+    return lines;
+}
+
+bool read_value(const fs::path& file, std::string& value) {
+    std::ifstream in(file);
+    return static_cast<bool>(in >> value);
+}
+
+bool to_number(const std::string& text, uint64_t& number) {
+    if (text.empty() || text[0] == '-') return false;
+    char* end = nullptr;
+    errno = 0;
+    unsigned long long parsed = std::strtoull(text.c_str(), &end, 10);
+    if (errno != 0 || *end != '\0') return false;
+    number = parsed;
+    return true;
+}
+
+void tighten(uint64_t& limit, uint64_t value) {
+    if (value > 0 && (limit == 0 || value < limit)) limit = value;
+}
+
+void tighten(double& limit, double value) {
+    if (value > 0 && (limit == 0 || value < limit)) limit = value;
+}
+
+// calls visit for the cgroup's directory and each parent up to the mount
+template <typename Visit>
+void walk_up(const fs::path& mount, const std::string& cgroup_path, Visit visit) {
+    std::error_code ec;
+    fs::path root = mount.lexically_normal();
+    if (!root.has_filename()) root = root.parent_path();
+    fs::path dir = (root / fs::path(cgroup_path).relative_path()).lexically_normal();
+    if (!dir.has_filename()) dir = dir.parent_path();
+    const std::string prefix = root.string();
+    if (dir.string().compare(0, prefix.size(), prefix) != 0 || !fs::is_directory(dir, ec)) dir = root;
+    while (true) {
+        visit(dir);
+        if (dir.string().size() <= prefix.size()) break;
+        dir = dir.parent_path();
+    }
+}
+
+void read_v2(const fs::path& mount, const std::string& cgroup_path, ResourceLimits& limits) {
+    walk_up(mount, cgroup_path, [&](const fs::path& dir) {
+        std::ifstream cpu(dir / "cpu.max");
+        std::string quota, period;
+        uint64_t q = 0, p = 0;
+        if (cpu >> quota >> period && to_number(quota, q) && to_number(period, p) && p > 0) {
+            tighten(limits.cpu_quota, static_cast<double>(q) / static_cast<double>(p));
+        }
+        for (const char* name : {"memory.max", "memory.high"}) {
+            std::string value;
+            uint64_t bytes = 0;
+            if (read_value(dir / name, value) && to_number(value, bytes)) tighten(limits.memory_limit, bytes);
+        }
+    });
+}
+
+// v1 mounts each controller on its own, usually at a directory named after the controller list
+fs::path v1_mount(const fs::path& root, const std::string& controllers, const std::string& wanted) {
+    std::error_code ec;
+    if (fs::is_directory(root / wanted, ec)) return root / wanted;
+    return root / controllers;
+}
+
+void read_v1(const fs::path& root, const std::vector<CgroupLine>& lines, ResourceLimits& limits) {
+    for (const CgroupLine& line : lines) {
+        std::stringstream names(line.controllers);
+        std::string name;
+        while (std::getline(names, name, ',')) {
+            if (name == "cpu") {
+                walk_up(v1_mount(root, line.controllers, "cpu"), line.path, [&](const fs::path& dir) {
+                    std::string quota, period;
+                    uint64_t q = 0, p = 0;
+                    if (read_value(dir / "cpu.cfs_quota_us", quota) && read_value(dir / "cpu.cfs_period_us", period) &&
+                        to_number(quota, q) && to_number(period, p) && p > 0) {
+                        tighten(limits.cpu_quota, static_cast<double>(q) / static_cast<double>(p));
+                    }
+                });
+            } else if (name == "memory") {
+                walk_up(v1_mount(root, line.controllers, "memory"), line.path, [&](const fs::path& dir) {
+                    std::string value;
+                    uint64_t bytes = 0;
+                    if (read_value(dir / "memory.limit_in_bytes", value) && to_number(value, bytes) &&
+                        bytes < unlimited_v1) {
+                        tighten(limits.memory_limit, bytes);
+                    }
+                });
+            }
+        }
+    }
+}
+
+} // namespace
+
+size_t ResourceLimits::cpus() const {
+    size_t count = std::max<size_t>(1, host_cpus);
+    if (affinity_cpus) count = std::min(count, affinity_cpus);
+    if (cpu_quota > 0) count = std::min(count, static_cast<size_t>(std::max(1.0, std::floor(cpu_quota))));
+    return count;
+}
+
+ResourceLimits read_resource_limits(const std::string& cgroup_root, const std::string& proc_cgroup) {
+    ResourceLimits limits;
+    limits.host_cpus = std::max(1u, std::thread::hardware_concurrency());
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) limits.affinity_cpus = static_cast<size_t>(CPU_COUNT(&set));
+#endif
+
+    const std::vector<CgroupLine> lines = read_cgroup_lines(proc_cgroup);
+    if (lines.empty()) return limits;
+    std::error_code ec;
+    const fs::path root(cgroup_root);
+    const bool unified = fs::exists(root / "cgroup.controllers", ec);
+    for (const CgroupLine& line : lines) {
+        if (unified && line.hierarchy == "0" && line.controllers.empty()) {
+            limits.cgroup_version = 2;
+            read_v2(root, line.path, limits);
+            return limits;
+        }
+    }
+    if (!unified) {
+        limits.cgroup_version = 1;
+        read_v1(root, lines, limits);
+    }
+    return limits;
+}
+
+const ResourceLimits& resource_limits() {
+    static const ResourceLimits limits = read_resource_limits();
+    return limits;
+}
+
+size_t available_cpus() {
+    return resource_limits().cpus();
+}
+
+bool parse_byte_size(const std::string& text, uint64_t& bytes) {
+    size_t digits = 0;
+    while (digits < text.size() && std::isdigit(static_cast<unsigned char>(text[digits]))) ++digits;
+    uint64_t number = 0;
+    if (digits == 0 || !to_number(text.substr(0, digits), number)) return false;
+
+    std::string suffix = text.substr(digits);
+    std::transform(suffix.begin(), suffix.end(), suffix.begin(), [](unsigned char c) { return std::tolower(c); });
+    if (suffix.size() > 1 && (suffix.compare(1, std::string::npos, "b") == 0 ||
+                              suffix.compare(1, std::string::npos, "ib") == 0)) {
+        suffix.resize(1);
+    }
+    int shift = 0;
+    if (suffix.empty() || suffix == "b") shift = 0;
+    else if (suffix == "k") shift = 10;
+    else if (suffix == "m") shift = 20;
+    else if (suffix == "g") shift = 30;
+    else if (suffix == "t") shift = 40;
+    else return false;
+    if (shift && number > (~uint64_t{0} >> shift)) return false;
+    bytes = number << shift;
+    return true;
+}
+
+bool lower_process_priority(std::string& error) {
+    bool ok = true;
+    errno = 0;
+    int nice_value = getpriority(PRIO_PROCESS, 0);
+    // an unprivileged process may raise its nice value but never lower it again
+    if (errno == 0 && nice_value < 10 && setpriority(PRIO_PROCESS, 0, 10) != 0) {
+        error = std::string("cannot lower CPU priority: ") + std::strerror(errno);
+        ok = false;
+    }
+#if defined(__linux__) && defined(SYS_ioprio_set)
+    // from linux/ioprio.h: IOPRIO_WHO_PROCESS and the idle class, which gets disk time only
+    // when nothing else wants it
+    constexpr int ioprio_who_process = 1;
+    constexpr int ioprio_class_idle = 3;
+    constexpr int ioprio_class_shift = 13;
+    if (syscall(SYS_ioprio_set, ioprio_who_process, 0, ioprio_class_idle << ioprio_class_shift) != 0) {
+        error = std::string("cannot lower I/O priority: ") + std::strerror(errno);
+        ok = false;
+    }
+#endif
+    return ok;
+}
+
+void MemoryBudget::acquire(uint64_t bytes) {
+    std::unique_lock<std::mutex> lock(mutex);
+    cv.wait(lock, [&] { return limit_bytes == 0 || buffers_held == 0 || buffers + results + bytes <= limit_bytes; });
+    buffers += bytes;
+    ++buffers_held;
+    peak_bytes = std::max(peak_bytes, buffers + results);
+}
+
+void MemoryBudget::release(uint64_t bytes) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        buffers -= std::min(bytes, buffers);
+        if (buffers_held) --buffers_held;
+    }
+    cv.notify_all();
+}
+
+void MemoryBudget::charge(uint64_t bytes) {
+    std::lock_guard<std::mutex> lock(mutex);
+    results += bytes;
+    peak_bytes = std::max(peak_bytes, buffers + results);
+}
+
+void MemoryBudget::discharge(uint64_t bytes) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        results -= std::min(bytes, results);
+    }
+    cv.notify_all();
+}
+
+uint64_t MemoryBudget::in_use() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return buffers + results;
+}
+
+uint64_t MemoryBudget::buffer_bytes() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return buffers;
+}
+
+uint64_t MemoryBudget::result_bytes() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return results;
+}
+
+uint64_t MemoryBudget::peak() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return peak_bytes;
+}
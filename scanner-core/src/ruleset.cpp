@@ -0,0 +1,359 @@
+/**
+ * @file ruleset.cpp
+ * @brief Implements RuleSet compilation and static analysis of rule patterns.
+ *
+ * Besides compiling each rule's regular expression, the RuleSet records two facts taken from
+ * the pattern source: the literal prefix that every match starts with and the longest match
+ * the pattern can produce. The matcher uses them to jump straight to candidate positions and
+ * to bound how far a single match attempt may look, which keeps long lines linear.
+ *
+ * The analysis understands the ECMAScript subset used by the rules (literals, escapes,
+ * classes, groups, alternation and quantifiers). Anything it does not understand is treated
+ * conservatively as unbounded.
+ *
+ * Rule scopes are compiled once into per-extension and per-file-name rule lists, so the
+ * rules that apply to a file are found without evaluating any glob for the common
+ * "*.ext" and exact-name scopes.
+ *
+ * @author Dorna Raj Gyawali <dronarajgyawali@gmail.com>
+ * @date 2025
+ */
+
+#include "ruleset.h"
+#include <cctype>
+#include <cstdint>
+#include <algorithm>
+#include <unordered_set>
+
+namespace {
+
+constexpr size_t UNBOUNDED = SIZE_MAX;
+
+size_t add_sat(size_t a, size_t b) {
+    return (a == UNBOUNDED || b == UNBOUNDED || a > UNBOUNDED - b) ? UNBOUNDED : a + b;
+}
+
+size_t mul_sat(size_t a, size_t b) {
+    if (a == 0 || b == 0) return 0;
+    if (a == UNBOUNDED || b == UNBOUNDED || a > UNBOUNDED / b) return UNBOUNDED;
+    return a * b;
+}
+
+class PatternParser {
+public:
+    explicit PatternParser(const std::string& source_) : s(source_) {}
+
+    PatternInfo run() {
+        size_t max_length = alternation();
+        PatternInfo info;
+        if (i != s.size()) max_length = UNBOUNDED;  // stray ')' or parse error
+        info.bounded = max_length != UNBOUNDED;
+        info.max_length = info.bounded ? max_length : 0;
+        if (!top_level_alternation) info.prefix = prefix;
+        return info;
+    }
+
+private:
+    const std::string& s;
+    size_t i = 0;
+    int depth = 0;
+    int last_literal = -1;
+    std::string prefix;
+    bool prefix_open = true;
+    bool top_level_alternation = false;
+
+    size_t alternation() {
+        size_t best = sequence();
+        while (i < s.size() && s[i] == '|') {
+            if (depth == 0) top_level_alternation = true;
+            ++i;
+            best = std::max(best, sequence());
+        }
+        return best;
+    }
+
+    size_t sequence() {
+        size_t total = 0;
+        while (i < s.size() && s[i] != '|' && s[i] != ')') {
+            size_t atom_length = atom();
+            int literal = last_literal;
+            auto [lo, hi] = quantifier();
+            total = add_sat(total, mul_sat(atom_length, hi));
+
+            if (depth == 0 && prefix_open) {
+                if (literal >= 0 && lo >= 1) {
+                    prefix += static_cast<char>(literal);
+                    if (lo != 1 || hi != 1) prefix_open = false;
+                } else {
+                    prefix_open = false;
+                }
+            }
+        }
+        return total;
+    }
+
+    size_t atom() {
+        last_literal = -1;
+        char c = s[i++];
+        switch (c) {
+        case '(': {
+            bool lookaround = false;
+            if (s.compare(i, 2, "?:") == 0) {
+                i += 2;
+            } else if (s.compare(i, 2, "?=") == 0 || s.compare(i, 2, "?!") == 0) {
+                i += 2;
+                lookaround = true;
+            }
+            ++depth;
+            size_t inner = alternation();
+            --depth;
+            last_literal = -1;
+            if (i < s.size() && s[i] == ')') {
+                ++i;
+            } else {
+                return UNBOUNDED;
+            }
+            return lookaround ? 0 : inner;
+        }
+        case '[': {
+            if (i < s.size() && s[i] == '^') ++i;
+            if (i < s.size() && s[i] == ']') ++i;
+            while (i < s.size() && s[i] != ']') {
+                if (s[i] == '\\') ++i;
+                ++i;
+            }
+            if (i >= s.size()) return UNBOUNDED;
+            ++i;
+            return 1;
+        }
+        case '\\': {
+            if (i >= s.size()) return UNBOUNDED;
+            char e = s[i++];
+            if (e == 'b' || e == 'B') return 0;
+            if (e >= '1' && e <= '9') return UNBOUNDED;  // back-reference
+            if (e == 'x') {
+                i += 2;
+            } else if (e == 'u') {
+                i += 4;
+            } else if (e == 'c') {
+                ++i;
+            } else if (!std::isalnum(static_cast<unsigned char>(e))) {
+                last_literal = static_cast<unsigned char>(e);
+            } else if (e == 'n' || e == 't' || e == 'r' || e == 'f' || e == 'v') {
+                last_literal = e == 'n' ? '\n' : e == 't' ? '\t' : e == 'r' ? '\r' : e == 'f' ? '\f' : '\v';
+            }
+            return 1;
+        }
+        case '^':
+        case '$':
+            return 0;
+        case '.':
+            return 1;
+        case '*':
+        case '+':
+        case '?':
+        case '{':
+            return UNBOUNDED;  // quantifier without an atom
+        default:
+            last_literal = static_cast<unsigned char>(c);
+            return 1;
+        }
+    }
+
+    std::pair<size_t, size_t> quantifier() {
+        if (i >= s.size()) return {1, 1};
+        std::pair<size_t, size_t> q{1, 1};
+        char c = s[i];
+        if (c == '*') {
+            q = {0, UNBOUNDED};
+            ++i;
+        } else if (c == '+') {
+            q = {1, UNBOUNDED};
+            ++i;
+        } else if (c == '?') {
+            q = {0, 1};
+            ++i;
+        } else if (c == '{') {
+            size_t j = i + 1;
+            size_t lo = 0, hi = 0;
+            bool digits = false;
+            while (j < s.size() && std::isdigit(static_cast<unsigned char>(s[j]))) {
+                lo = lo * 10 + static_cast<size_t>(s[j++] - '0');
+                digits = true;
+            }
+            if (!digits) return q;
+            hi = lo;
+            if (j < s.size() && s[j] == ',') {
+                ++j;
+                if (j < s.size() && std::isdigit(static_cast<unsigned char>(s[j]))) {
+                    hi = 0;
+                    while (j < s.size() && std::isdigit(static_cast<unsigned char>(s[j]))) {
+                        hi = hi * 10 + static_cast<size_t>(s[j++] - '0');
+                    }
+                } else {
+                    hi = UNBOUNDED;
+                }
+            }
+            if (j >= s.size() || s[j] != '}') return q;
+            i = j + 1;
+            q = {lo, hi};
+        } else {
+            return q;
+        }
+        if (i < s.size() && s[i] == '?') ++i;  // lazy form has the same bounds
+        return q;
+    }
+};
+
+std::string lower(std::string_view text) {
+    std::string out(text);
+    for (char& c : out) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    return out;
+}
+
+std::string_view file_name(std::string_view path) {
+    size_t slash = path.find_last_of("/\\");
+    return slash == std::string_view::npos ? path : path.substr(slash + 1);
+}
+
+// everything from the last dot, so ".env" is its own extension and "*.env" matches it
+std::string_view extension(std::string_view name) {
+    size_t dot = name.rfind('.');
+    return dot == std::string_view::npos ? std::string_view() : name.substr(dot);
+}
+
+bool is_extension_glob(std::string_view entry) {
+    return entry.size() > 2 && entry.compare(0, 2, "*.") == 0 &&
+           entry.find_first_of("*?[/", 2) == std::string_view::npos;
+}
+
+bool is_plain_name(std::string_view entry) {
+    return !entry.empty() && entry.find_first_of("*?[/") == std::string_view::npos;
+}
+
+std::string_view strip_negation(std::string_view entry) {
+    return !entry.empty() && entry[0] == '!' ? entry.substr(1) : entry;
+}
+
+// decides a scope made only of "*.ext" and exact-name entries for one lowercase file name
+bool scope_applies(const std::vector<std::string>& scope, std::string_view ext, std::string_view name) {
+    bool has_include = false, included = false;
+    for (const auto& raw : scope) {
+        bool negated = !raw.empty() && raw[0] == '!';
+        std::string entry = lower(strip_negation(raw));
+        bool hit = is_extension_glob(entry) ? ext == std::string_view(entry).substr(1) : name == entry;
+        if (negated) {
+            if (hit) return false;
+        } else {
+            has_include = true;
+            included = included || hit;
+        }
+    }
+    return !has_include || included;
+}
+
+} // namespace
+
+PatternInfo analyze_pattern(const std::string& pattern) {
+    return PatternParser(pattern).run();
+}
+
+RuleSet::RuleSet(const std::vector<RuleDefinition>& definitions) {
+    rule_list.reserve(definitions.size());
+    for (const auto& def : definitions) {
+        auto flags = std::regex_constants::ECMAScript;
+        if (def.icase) flags |= std::regex_constants::icase;
+        Rule rule;
+        rule.name = def.name;
+        rule.pattern = def.pattern;
+        rule.regex = std::regex(def.pattern, flags);
+        rule.icase = def.icase;
+        rule.info = analyze_pattern(def.pattern);
+        if (!def.end.empty()) {
+            rule.spans_lines = true;
+            rule.end_pattern = def.end;
+            rule.end = std::regex(def.end, flags);
+            rule.end_info = analyze_pattern(def.end);
+        }
+        rule.scope = def.scope;
+        rule_list.push_back(std::move(rule));
+    }
+    build_scope_index();
+}
+
+RuleSet::RuleSet(const std::vector<std::pair<std::string, std::regex>>& patterns) {
+    rule_list.reserve(patterns.size());
+    for (const auto& [name, regex] : patterns) {
+        Rule rule;
+        rule.name = name;
+        rule.regex = regex;
+        rule_list.push_back(std::move(rule));
+    }
+    build_scope_index();
+}
+
+void RuleSet::build_scope_index() {
+    std::vector<uint32_t> indexed;
+    std::unordered_set<std::string> extensions, names;
+    for (uint32_t r = 0; r < rule_list.size(); ++r) {
+        all.push_back(r);
+        const auto& scope = rule_list[r].scope;
+        bool simple = std::all_of(scope.begin(), scope.end(), [](const std::string& raw) {
+            std::string_view entry = strip_negation(raw);
+            return is_extension_glob(entry) || is_plain_name(entry);
+        });
+        if (!simple) {
+            GlobScope glob{r, PathFilter(), false};
+            for (const auto& raw : scope) {
+                std::string entry = lower(strip_negation(raw));
+                if (raw[0] == '!') {
+                    glob.filter.add_exclude(entry);
+                } else {
+                    glob.filter.add_include(entry);
+                    glob.has_include = true;
+                }
+            }
+            glob_scopes.push_back(std::move(glob));
+            continue;
+        }
+        indexed.push_back(r);
+        for (const auto& raw : scope) {
+            std::string entry = lower(strip_negation(raw));
+            if (is_extension_glob(entry)) extensions.insert(entry.substr(1));
+            else names.insert(entry);
+        }
+    }
+
+    auto subset = [&](std::string_view ext, std::string_view name) {
+        std::vector<uint32_t> list;
+        for (uint32_t r : indexed) {
+            if (scope_applies(rule_list[r].scope, ext, name)) list.push_back(r);
+        }
+        return list;
+    };
+    // no scope entry can match a control character, so this is the answer for unlisted files
+    unlisted = subset("\x01", "\x01");
+    for (const auto& ext : extensions) by_extension.emplace(ext, subset(ext, ""));
+    for (const auto& name : names) by_name.emplace(name, subset(extension(name), name));
+}
+
+const std::vector<uint32_t>& RuleSet::rules_for(std::string_view path, std::vector<uint32_t>& scratch) const {
+    if (by_extension.empty() && by_name.empty() && glob_scopes.empty()) return all;
+
+    const std::string name = lower(file_name(path));
+    const std::vector<uint32_t>* list = &unlisted;
+    if (auto it = by_name.find(name); it != by_name.end()) {
+        list = &it->second;
+    } else if (auto ext = by_extension.find(std::string(extension(name))); ext != by_extension.end()) {
+        list = &ext->second;
+    }
+    if (glob_scopes.empty()) return *list;
+
+    scratch.assign(list->begin(), list->end());
+    for (const auto& glob : glob_scopes) {
+        PathFilter::Match m = glob.filter.match(name, false);
+        if ((!glob.has_include || m.included) && !m.excluded) scratch.push_back(glob.rule);
+    }
+    std::sort(scratch.begin(), scratch.end());
+    return scratch;
+}
@@ -12,33 +12,312 @@
  * - Detection of secrets using user-defined regex patterns.
  * - Integration with git to skip ignored files.
  * - Outputs findings in a structured JSON format.
+ * - Rules that span lines, such as whole PEM private key blocks.
+ * - Fixed-size sliding window scan for very large files and unbounded input.
+ * - Results appended to a caller-owned FindingBuffer without per-finding allocations.
+ * - Incremental scanning of pipes and growing logs, with optional redacted pass-through.
+ * - Trace spans for git checks, reporting and, on request, each rule.
+ * - Optional decoding of base64 and hex runs, matched within a fixed byte budget.
  *
  * @author Dorna Raj Gyawali <dronarajgyawali@gmail.com>
  * @date 2025
  */
 
 #include "scanner.h"
+#include "decoder.h"
+#include "linecounter.h"
+#include "trace.h"
+#include <algorithm>
 #include <iostream>
 #include <fstream>
 #include <cstdlib>
 #include <string>
+#include <string_view>
 #include <sstream>
+#include <cctype>
+#include <ctime>
+#include <optional>
+
+namespace {
+
+// a match before its line, column and text are known
+Finding raw_match(size_t offset, size_t length, size_t rule) {
+    Finding finding;
+    finding.rule = static_cast<uint32_t>(rule);
+    finding.offset = offset;
+    finding.length = static_cast<uint32_t>(length);
+    return finding;
+}
+
+// report order: by offset, then by rule
+void sort_matches(std::vector<Finding>& matches, size_t first) {
+    std::sort(matches.begin() + static_cast<std::ptrdiff_t>(first), matches.end(),
+              [](const Finding& a, const Finding& b) {
+                  return a.offset != b.offset ? a.offset < b.offset : a.rule < b.rule;
+              });
+}
+
+/**
+ * Tracks CPU time spent on the current file by the calling thread.
+ */
+class CpuBudget {
+public:
+    explicit CpuBudget(std::chrono::milliseconds budget_)
+        : budget(budget_), start(budget_.count() > 0 ? now() : std::chrono::nanoseconds(0)) {}
+
+    // a budget that started earlier, for scans spread over several calls
+    CpuBudget(std::chrono::milliseconds budget_, std::chrono::nanoseconds start_) : budget(budget_), start(start_) {}
+
+    bool exceeded() const {
+        return budget.count() > 0 && now() - start > budget;
+    }
+
+    static std::chrono::nanoseconds now() {
+#if defined(CLOCK_THREAD_CPUTIME_ID)
+        timespec ts;
+        if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) == 0) {
+            return std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec);
+        }
+#endif
+        return std::chrono::steady_clock::now().time_since_epoch();
+    }
+
+private:
+    std::chrono::milliseconds budget;
+    std::chrono::nanoseconds start;
+};
+
+size_t longest_line(std::string_view content) {
+    size_t longest = 0;
+    size_t start = 0;
+    while (start < content.size()) {
+        size_t end = content.find('\n', start);
+        if (end == std::string::npos) end = content.size();
+        longest = std::max(longest, end - start);
+        start = end + 1;
+    }
+    return longest;
+}
+
+size_t find_prefix(std::string_view content, const std::string& prefix, size_t from, bool icase) {
+    if (!icase) return content.find(prefix, from);
+    auto it = std::search(content.begin() + from, content.end(), prefix.begin(), prefix.end(),
+                          [](char a, char b) {
+                              return std::tolower(static_cast<unsigned char>(a)) ==
+                                     std::tolower(static_cast<unsigned char>(b));
+                          });
+    return it == content.end() ? std::string::npos : static_cast<size_t>(it - content.begin());
+}
+
+/**
+ * A rule that spans lines continues from its opening match through the first closing match
+ * that ends within block_span bytes of the opening. The closing pattern is only tried where
+ * its literal prefix occurs, so the body is never fed through std::regex. Without a closing
+ * match the opening is reported on its own.
+ */
+size_t block_length(const MatchEngine& engine, uint32_t r, std::string_view content, size_t offset, size_t length,
+                    const ScanLimits& limits) {
+    const Rule& rule = engine.get_rules().rules()[r];
+    const std::string_view area = content.substr(0, std::min(content.size(), offset + limits.block_span));
+    const std::string& prefix = rule.end_info.prefix;
+    MatchEngine::Match match;
+    for (size_t pos = offset + length; pos < area.size();) {
+        size_t candidate = prefix.empty() ? pos : find_prefix(area, prefix, pos, rule.icase);
+        if (candidate == std::string::npos) break;
+        if (engine.search(r, MatchEngine::Part::closing, area, candidate, area.size(), !prefix.empty(), match)) {
+            return match.offset + match.length - offset;
+        }
+        if (prefix.empty()) break;
+        pos = candidate + 1;
+    }
+    return length;
+}
+
+bool match_whole(std::string_view content, const MatchEngine& engine, const std::vector<uint32_t>& active,
+                 const ScanLimits& limits, std::vector<Finding>& matches, const CpuBudget& budget) {
+    const std::vector<Rule>& rules = engine.get_rules().rules();
+
+    // patterns run over the whole buffer; only rules with a closing pattern cross newlines.
+    // The budget is checked between rules only: one regex_search cannot be interrupted, which
+    // is why this path is limited to files whose lines fit under --max-line-length
+    const bool trace_rules = TraceRecorder::tracing_rules();
+    for (uint32_t r : active) {
+        if (budget.exceeded()) return false;
+        std::optional<TraceSpan> span;
+        if (trace_rules) span.emplace("rule", rules[r].name);
+
+        MatchEngine::Match match;
+        size_t start = 0;
+        while (start <= content.size() &&
+               engine.search(r, MatchEngine::Part::opening, content, start, content.size(), false, match)) {
+            size_t length = match.length;
+            if (rules[r].spans_lines) length = block_length(engine, r, content, match.offset, length, limits);
+            matches.push_back(raw_match(match.offset, length, r));
+            start = match.offset + length + (length == 0 ? 1 : 0);
+        }
+    }
+    return true;
+}
+
+/**
+ * Linear-time matching for buffers with very long lines. Rules with a literal prefix are only
+ * tried where the prefix occurs, and every attempt is confined to a window no longer than the
+ * rule's longest possible match (or the guard window for unbounded rules), so std::regex can
+ * neither go quadratic nor recurse deeply on a multi-megabyte line.
+ *
+ * The buffer may be one window of a longer stream: base is the stream offset of content[0],
+ * only matches starting before accept_end are taken, and resume holds, per rule, the stream
+ * offset where the next match may start. Reported offsets are stream offsets. Only the
+ * rules listed in active are run.
+ */
+bool match_guarded(std::string_view content, size_t base, size_t accept_end, const MatchEngine& engine,
+                   const std::vector<uint32_t>& active, const ScanLimits& limits, std::vector<size_t>& resume,
+                   std::vector<Finding>& matches, const CpuBudget& budget) {
+    const std::vector<Rule>& rules = engine.get_rules().rules();
+    const size_t chunk = 16 * 1024;
+
+    const bool trace_rules = TraceRecorder::tracing_rules();
+    for (uint32_t r : active) {
+        const Rule& rule = rules[r];
+        std::optional<TraceSpan> span;
+        if (trace_rules) span.emplace("rule", rule.name);
+        const std::string& prefix = rule.info.prefix;
+        const size_t window = rule.info.bounded ? rule.info.max_length : limits.guard_window;
+
+        size_t pos = resume[r] > base ? resume[r] - base : 0;
+        size_t line_end = 0;
+        size_t attempts = 0;
+        MatchEngine::Match match;
+
+        while (pos < accept_end) {
+            if (++attempts % 64 == 0 && budget.exceeded()) return false;
+
+            size_t candidate = prefix.empty() ? pos : find_prefix(content, prefix, pos, rule.icase);
+            if (candidate == std::string::npos || candidate >= accept_end) break;
+            if (candidate >= line_end) {
+                line_end = content.find('\n', candidate);
+                if (line_end == std::string::npos) line_end = content.size();
+            }
+
+            if (!prefix.empty()) {
+                // every match starts with the prefix, so only try a match right here
+                size_t limit = std::min(line_end, candidate + std::max(window, prefix.size()));
+                if (engine.search(r, MatchEngine::Part::opening, content, candidate, limit, true, match)) {
+                    size_t length = match.length;
+                    if (rule.spans_lines) length = block_length(engine, r, content, candidate, length, limits);
+                    matches.push_back(raw_match(base + candidate, length, r));
+                    pos = candidate + std::max<size_t>(length, 1);
+                } else {
+                    pos = candidate + 1;
+                }
+                continue;
+            }
+
+            // no prefix: search chunk by chunk, overlapping by the window so no match is cut
+            size_t accept_chunk = std::min({line_end, candidate + chunk, accept_end});
+            size_t search_end = std::min(line_end, accept_chunk + window);
+            if (engine.search(r, MatchEngine::Part::opening, content, candidate, search_end, false, match) &&
+                match.offset < accept_chunk) {
+                size_t offset = match.offset;
+                size_t length = match.length;
+                if (rule.spans_lines) length = block_length(engine, r, content, offset, length, limits);
+                matches.push_back(raw_match(base + offset, length, r));
+                pos = offset + std::max<size_t>(length, 1);
+            } else {
+                pos = accept_chunk == line_end ? line_end + 1 : accept_chunk;
+            }
+        }
+        // nothing else can start before accept_end; a match may have ended beyond it
+        resume[r] = base + std::max(pos, accept_end);
+    }
+    return true;
+}
+
+/**
+ * Decodes the base64 and hex runs of text and runs the rules over each decoded run that is
+ * mostly printable, then over the runs inside it, down to depth layers. Findings are placed
+ * at the encoded characters they came from in text, and their decoded text goes to texts.
+ * Every decoded byte is charged to budget_left, so a file that is mostly encoded data costs
+ * a bounded amount of extra matching.
+ */
+bool match_decoded(std::string_view text, const MatchEngine& engine, const std::vector<uint32_t>& active,
+                   const ScanLimits& limits, size_t depth, size_t& budget_left, std::vector<Finding>& matches,
+                   std::string& texts, const CpuBudget& budget) {
+    std::vector<EncodedRun> runs;
+    find_encoded_runs(text, limits.decode_min_length, runs);
+    std::string decoded;
+    std::vector<Finding> inner;
+    std::vector<size_t> resume;
+    for (const EncodedRun& run : runs) {
+        if (decoded_length(run) > budget_left) continue;
+        decode_run(text, run, decoded);
+        budget_left -= decoded.size();
+        if (!looks_like_text(decoded)) continue;
+
+        inner.clear();
+        resume.assign(engine.get_rules().rules().size(), 0);
+        if (!match_guarded(decoded, 0, decoded.size(), engine, active, limits, resume, inner, budget)) return false;
+        for (Finding& f : inner) {
+            f.text = texts.size();
+            texts.append(decoded, f.offset, f.length);
+        }
+        if (depth > 1 && !match_decoded(decoded, engine, active, limits, depth - 1, budget_left, inner, texts, budget)) {
+            return false;
+        }
+        for (Finding f : inner) {
+            f.offset = encoded_offset(run, f.offset);
+            f.decoded = static_cast<uint8_t>(f.decoded + 1);
+            matches.push_back(f);
+        }
+    }
+    return true;
+}
+
+// longest stretch of input a single guarded match attempt can look at
+size_t longest_match(const std::vector<Rule>& rules, const ScanLimits& limits) {
+    size_t longest = 1;
+    for (const auto& rule : rules) {
+        size_t window = rule.info.bounded ? rule.info.max_length : limits.guard_window;
+        if (rule.spans_lines) window = std::max(window, limits.block_span);
+        longest = std::max({longest, window, rule.info.prefix.size()});
+    }
+    return longest;
+}
+
+} // namespace
 
 SecretScanner::SecretScanner(
     const std::unordered_set<std::string>& ignored_dirs_,
     const std::unordered_set<std::string>& valid_extensions_,
     const std::vector<std::pair<std::string, std::regex>>& secret_patterns_)
-    : ignored_dirs(ignored_dirs_), valid_extensions(valid_extensions_), secret_patterns(secret_patterns_) 
+    : ignored_dirs(ignored_dirs_), valid_extensions(valid_extensions_),
+      rules(std::make_shared<const RuleSet>(secret_patterns_)), engine(make_engine("std", rules))
+    {}
+
+SecretScanner::SecretScanner(
+    const std::unordered_set<std::string>& ignored_dirs_,
+    const std::unordered_set<std::string>& valid_extensions_,
+    std::shared_ptr<const RuleSet> rules_)
+    : ignored_dirs(ignored_dirs_), valid_extensions(valid_extensions_), rules(std::move(rules_)),
+      engine(make_engine("std", rules))
     {}
 
+void SecretScanner::set_engine(std::shared_ptr<const MatchEngine> engine_) {
+    rules = engine_->shared_rules();
+    engine = std::move(engine_);
+}
+
 bool SecretScanner::is_ignored_dir(const fs::path& path) const {
-    std::string path_str = path.generic_string();
-    for (const auto& d : ignored_dirs) {
-        if (path_str.find("/" + d + "/") != std::string::npos ||
-            (path_str.size() >= d.size() + 1 &&
-             path_str.compare(path_str.size() - d.size() - 1, d.size() + 1, "/" + d) == 0)) {
+    // one set lookup per path component instead of a substring search per ignored name
+    const std::string path_str = path.generic_string();
+    size_t pos = path_str.find('/');
+    while (pos != std::string::npos) {
+        size_t next = path_str.find('/', pos + 1);
+        size_t len = (next == std::string::npos ? path_str.size() : next) - pos - 1;
+        if (len > 0 && ignored_dirs.count(path_str.substr(pos + 1, len))) {
             return true;
         }
+        pos = next;
     }
     return false;
 }
@@ -48,11 +327,12 @@ bool SecretScanner::is_valid_extension(const fs::path& path) const {
 }
 
 bool SecretScanner::is_git_ignored(const std::string& file) const {
+    TraceSpan span("walk", "git check-ignore", file);
     std::string cmd = "git check-ignore \"" + file + "\" > /dev/null 2>&1";
     return system(cmd.c_str()) == 0;
 }
 
-void SecretScanner::report_secret(const std::string& file_path, int line_number, 
+void SecretScanner::report_secret(const std::string& file_path, int line_number, int column, size_t offset,
                                  const std::string& pattern_name, const std::string& match_str) const {
     std::lock_guard<std::mutex> lock(output_mutex);
     
@@ -81,34 +361,268 @@ void SecretScanner::report_secret(const std::string& file_path, int line_number,
     std::cout << "{"
               << R"("file":")" << file_path << "\","
               << R"("line":)" << line_number << ","
+              << R"("column":)" << column << ","
+              << R"("offset":)" << offset << ","
               << R"("type":")" << pattern_name << "\","
               << R"("match":")" << cleaned_match << "\""
               << "}" << std::endl;
 }
 
 void SecretScanner::scan_file(const std::string& file_path) const {
-    std::ifstream file(file_path);
-    if (!file.is_open()) {
+    if (should_stream(file_path)) {
+        std::ifstream file(file_path, std::ios::binary);
+        if (file.is_open()) scan_stream(file_path, file);
+        return;
+    }
+    std::string content;
+    if (!read_file(file_path, content)) {
         // silently skip files that can't be opened (they might be binary or locked)
         return;
     }
+    scan_buffer(file_path, content);
+}
 
-    std::string line;
-    int line_number = 0;
-
-    while (std::getline(file, line)) {
-        ++line_number;
-        
-        for (const auto& [pattern_name, pattern] : secret_patterns) {
-            std::smatch match;
-            std::string::const_iterator start = line.cbegin();
-            
-            // lets find all matches in the line
-            while (std::regex_search(start, line.cend(), match, pattern)) {
-                std::string match_str = match.str();
-                report_secret(file_path, line_number, pattern_name, match_str);
-                start = match.suffix().first;
+bool SecretScanner::read_file(const std::string& file_path, std::string& content) const {
+    std::ifstream file(file_path, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    file.seekg(0, std::ios::end);
+    std::streamoff size = file.tellg();
+    file.seekg(0, std::ios::beg);
+    if (size > 0) {
+        content.resize(static_cast<size_t>(size));
+        file.read(&content[0], size);
+        content.resize(static_cast<size_t>(file.gcount()));
+    } else {
+        // size unknown (pipes, procfs); fall back to reading until EOF
+        std::ostringstream ss;
+        ss << file.rdbuf();
+        content = ss.str();
+    }
+    return true;
+}
+
+bool SecretScanner::should_stream(const std::string& file_path, uint64_t* size) const {
+    std::error_code ec;
+    uint64_t file_size = static_cast<uint64_t>(fs::file_size(file_path, ec));
+    if (ec) return false;
+    if (size) *size = file_size;
+    return file_size > limits.stream_threshold;
+}
+
+void SecretScanner::report_findings(const std::string& file_path, const FindingBuffer& findings) const {
+    for (const Finding& finding : findings) {
+        report_secret(file_path, static_cast<int>(finding.line), static_cast<int>(finding.column), finding.offset,
+                      rules->rules()[finding.rule].name, std::string(findings.text(finding)));
+    }
+}
+
+void SecretScanner::report_partial_scan(const std::string& file_path, const std::string& reason) const {
+    std::lock_guard<std::mutex> lock(output_mutex);
+    std::cerr << "warning: partially scanned " << file_path << ": " << reason << std::endl;
+}
+
+bool SecretScanner::scan_buffer(std::string_view content, uint32_t file_id, FindingBuffer& out,
+                                std::string_view scope_path) const {
+    thread_local std::vector<uint32_t> scratch;
+    const std::vector<uint32_t>& active = scope_path.empty() ? rules->all_rules()
+                                                              : rules->rules_for(scope_path, scratch);
+    std::vector<Finding>& matches = out.items;
+    const size_t first = matches.size();
+    CpuBudget budget(limits.file_budget);
+
+    // the guarded matcher finds the same secrets as plain regex_search whenever no line is
+    // longer than the guard window, and jumping between literal prefixes is much cheaper
+    // than one regex_search per rule over the whole buffer (see bench_scanner); the plain
+    // search only remains for lines between the guard window and the long line threshold
+    std::vector<size_t> resume(rules->rules().size(), 0);
+    size_t longest = longest_line(content);
+    bool complete = longest > limits.guard_window && longest <= limits.long_line_length
+        ? match_whole(content, *engine, active, limits, matches, budget)
+        : match_guarded(content, 0, content.size(), *engine, active, limits, resume, matches, budget);
+
+    // decoded findings keep their text here until they are copied into the arena
+    thread_local std::string decoded_texts;
+    decoded_texts.clear();
+    if (complete && limits.decode_depth > 0) {
+        TraceSpan span("match", "decode", scope_path);
+        size_t budget_left = limits.decode_budget + content.size() / 4;
+        complete = match_decoded(content, *engine, active, limits, limits.decode_depth, budget_left, matches,
+                                 decoded_texts, budget);
+    }
+
+    if (matches.size() > first) {
+        // line numbers are only computed for findings, in one forward pass
+        sort_matches(matches, first);
+        LineCounter lines(content);
+        for (size_t i = first; i < matches.size(); ++i) {
+            Finding& m = matches[i];
+            LineCounter::Position pos = lines.locate(m.offset);
+            m.file = file_id;
+            m.line = pos.line;
+            m.column = pos.column;
+            const size_t text = m.text;
+            m.text = out.arena.size();
+            if (m.decoded) out.arena.append(decoded_texts, text, m.length);
+            else out.arena.append(content.data() + m.offset, m.length);
+        }
+    }
+    return complete;
+}
+
+void SecretScanner::scan_buffer(const std::string& file_path, std::string_view content) const {
+    // one buffer per thread, so scanning file after file stops allocating for results
+    thread_local FindingBuffer findings;
+    findings.clear();
+    bool complete = scan_buffer(content, 0, findings, file_path);
+    if (!findings.empty()) {
+        // reporting takes the output lock, so its time shows contention between matchers
+        TraceSpan span("output", "report", file_path);
+        report_findings(file_path, findings);
+    }
+
+    if (!complete) {
+        report_partial_scan(file_path, "exceeded the " + std::to_string(limits.file_budget.count()) +
+                                       " ms CPU budget");
+    }
+}
+
+
+void SecretScanner::scan_stream(const std::string& file_path, std::istream& input) const {
+    IncrementalScan scan(*this, file_path);
+    std::string chunk(std::max<size_t>(limits.stream_window, 4096), '\0');
+    while (input.read(&chunk[0], static_cast<std::streamsize>(chunk.size())) || input.gcount() > 0) {
+        if (!scan.feed(std::string_view(chunk.data(), static_cast<size_t>(input.gcount())))) break;
+    }
+    scan.finish();
+    if (!scan.stopped() && input.bad()) report_partial_scan(file_path, "read error");
+}
+
+IncrementalScan::IncrementalScan(const SecretScanner& scanner_, std::string name_, Output redacted_)
+    : scanner(scanner_), name(std::move(name_)), redacted(std::move(redacted_)),
+      // a match starting anywhere in the accepted part of a window ends inside the overlap
+      overlap(longest_match(scanner_.get_rules().rules(), scanner_.get_limits())),
+      cpu_start(CpuBudget::now()),
+      resume(scanner_.get_rules().rules().size(), 0) {
+    std::vector<uint32_t> scratch;
+    active = scanner.get_rules().rules_for(name, scratch);
+}
+
+bool IncrementalScan::feed(std::string_view data) {
+    if (budget_exceeded) return false;
+    window.append(data.data(), data.size());
+    scan(false);
+    return !budget_exceeded;
+}
+
+void IncrementalScan::finish() {
+    if (!budget_exceeded) scan(true);
+    if (budget_exceeded) {
+        scanner.report_partial_scan(name, "exceeded the " + std::to_string(scanner.get_limits().file_budget.count()) +
+                                          " ms CPU budget");
+    }
+}
+
+void IncrementalScan::scan(bool at_end) {
+    const ScanLimits& limits = scanner.get_limits();
+    const size_t start = accepted - base;  // window index of the first byte not yet scanned
+
+    size_t accept_end = window.size();
+    if (!at_end) {
+        // complete lines only; a line longer than the window is taken in overlapping pieces
+        size_t newline = window.rfind('\n');
+        accept_end = newline == std::string::npos || newline < start ? start : newline + 1;
+        if (window.size() > limits.stream_window + overlap) {
+            accept_end = std::max(accept_end, window.size() - overlap);
+        }
+        accept_end = held_block(accept_end);
+    }
+    if (accept_end <= start) return;
+
+    findings.clear();
+    CpuBudget budget(limits.file_budget, cpu_start);
+    if (!match_guarded(window, base, accept_end, scanner.get_engine(), active, limits, resume, findings.items, budget)) {
+        budget_exceeded = true;
+    }
+
+    sort_matches(findings.items, 0);
+    for (Finding& m : findings.items) {
+        LineCounter::Position pos = lines.locate(window, base, m.offset);
+        m.line = pos.line;
+        m.column = pos.column;
+        m.text = findings.arena.size();
+        findings.arena.append(window, m.offset - base, m.length);
+    }
+    if (!findings.empty()) {
+        TraceSpan span("output", "report", name);
+        scanner.report_findings(name, findings);
+    }
+    // after the budget runs out nothing is passed through, since the rest was not scanned
+    if (redacted && !budget_exceeded) pass_through(base + accept_end);
+    accepted = base + accept_end;
+
+    // keep one byte of look-behind plus anything a match may still extend into
+    size_t keep_from = accept_end - 1;
+    lines.locate(window, base, base + keep_from);
+    window.erase(0, keep_from);
+    base += keep_from;
+}
+
+// the first multi-line block opening before accept_end whose closing match may still arrive
+size_t IncrementalScan::held_block(size_t accept_end) const {
+    const MatchEngine& engine = scanner.get_engine();
+    const std::vector<Rule>& rules = engine.get_rules().rules();
+    const ScanLimits& limits = scanner.get_limits();
+    MatchEngine::Match match;
+    for (uint32_t r : active) {
+        const Rule& rule = rules[r];
+        const std::string& prefix = rule.info.prefix;
+        if (!rule.spans_lines || prefix.empty()) continue;
+        const size_t span = std::max(rule.info.bounded ? rule.info.max_length : limits.guard_window, prefix.size());
+
+        size_t pos = std::max(resume[r], accepted) - base;
+        while (pos < accept_end) {
+            size_t candidate = find_prefix(window, prefix, pos, rule.icase);
+            if (candidate == std::string::npos || candidate >= accept_end) break;
+            size_t line_end = window.find('\n', candidate);
+            if (line_end == std::string::npos) line_end = window.size();
+            if (!engine.search(r, MatchEngine::Part::opening, window, candidate,
+                               std::min(line_end, candidate + span), true, match)) {
+                pos = candidate + 1;
+                continue;
             }
+            size_t length = match.length;
+            if (window.size() - candidate < limits.block_span &&
+                block_length(engine, r, window, candidate, length, limits) == length) {
+                accept_end = candidate;
+                break;
+            }
+            pos = candidate + std::max<size_t>(length, 1);
+        }
+    }
+    return accept_end;
+}
+
+void IncrementalScan::pass_through(size_t until) {
+    const std::vector<Rule>& rules = scanner.get_rules().rules();
+    for (const Finding& m : findings) {
+        size_t end = m.offset + m.length;
+        if (end <= redact_until) continue;
+        // overlapping matches (one secret, several rules) share one marker
+        if (m.offset >= redact_until) {
+            copy_to(m.offset);
+            redacted("[REDACTED:" + rules[m.rule].name + "]");
         }
+        redact_until = end;
     }
-}
\ No newline at end of file
+    copy_to(until);
+}
+
+// passes stream offsets [emitted, target) through, skipping masked bytes
+void IncrementalScan::copy_to(size_t target) {
+    if (emitted < redact_until) emitted = std::min(redact_until, target);
+    if (emitted < target) redacted(std::string_view(window).substr(emitted - base, target - emitted));
+    emitted = std::max(emitted, target);
+}
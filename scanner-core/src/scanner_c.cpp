@@ -0,0 +1,206 @@
+/**
+ * @file scanner_c.cpp
+ * @brief Implements the C interface of libscanner_core.
+ *
+ * Each handle wraps the C++ object it stands for: a ruleset owns a shared_ptr to an
+ * immutable RuleSet and a scanner is a SecretScanner whose report hooks forward findings to
+ * the caller's callback instead of printing them. Every entry point catches exceptions and
+ * turns them into result codes.
+ *
+ * Features:
+ * - Rulesets built from the default rules or caller-supplied definitions.
+ * - Zero-copy scanning of caller buffers; findings point into the scanned bytes.
+ * - Early stop from the callback and per-scan CPU budget reporting.
+ *
+ * @author Dorna Raj Gyawali <dronarajgyawali@gmail.com>
+ * @date 2025
+ */
+
+#include "scanner_c.h"
+#include "scanner.h"
+#include "ruleset.h"
+#include "regexpattern.h"
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <regex>
+#include <string>
+#include <string_view>
+
+struct ss_ruleset {
+    std::shared_ptr<const RuleSet> rules;
+};
+
+namespace {
+
+class CallbackScanner : public SecretScanner {
+public:
+    explicit CallbackScanner(std::shared_ptr<const RuleSet> rules_)
+        : SecretScanner({}, {}, std::move(rules_)) {}
+
+    int run(const char* data, size_t len, const char* label, ss_finding_cb callback_, void* user_data_) {
+        base = data;
+        path = label ? label : "";
+        callback = callback_;
+        user_data = user_data_;
+        stopped = false;
+        partial = false;
+        scan_buffer(path, std::string_view(data, len));
+        return stopped ? SS_STOPPED : partial ? SS_PARTIAL : SS_OK;
+    }
+
+    void report_findings(const std::string&, const FindingBuffer& findings) const override {
+        for (const Finding& found : findings) {
+            if (stopped || !callback) return;
+            ss_finding finding;
+            finding.rule = get_rules().rules()[found.rule].name.c_str();
+            finding.path = path.c_str();
+            finding.match = base + found.offset;
+            finding.match_len = found.length;
+            finding.offset = found.offset;
+            finding.line = found.line;
+            finding.column = found.column;
+            if (callback(&finding, user_data) != 0) stopped = true;
+        }
+    }
+
+    void report_partial_scan(const std::string&, const std::string&) const override {
+        partial = true;
+    }
+
+private:
+    const char* base = nullptr;
+    std::string path;
+    ss_finding_cb callback = nullptr;
+    void* user_data = nullptr;
+    mutable bool stopped = false;
+    mutable bool partial = false;
+};
+
+void write_error(char* error, size_t error_size, const std::string& message) {
+    if (!error || error_size == 0) return;
+    size_t n = std::min(message.size(), error_size - 1);
+    std::memcpy(error, message.data(), n);
+    error[n] = '\0';
+}
+
+} // namespace
+
+struct ss_scanner {
+    CallbackScanner scanner;
+};
+
+extern "C" {
+
+const char* ss_version(void) {
+    return "1.0.0";
+}
+
+const char* ss_strerror(int code) {
+    switch (code) {
+    case SS_OK: return "ok";
+    case SS_STOPPED: return "stopped by callback";
+    case SS_PARTIAL: return "CPU budget exceeded, scan incomplete";
+    case SS_ERR_INVALID_ARGUMENT: return "invalid argument";
+    case SS_ERR_IO: return "cannot read file";
+    case SS_ERR_INTERNAL: return "internal error";
+    default: return "unknown error";
+    }
+}
+
+ss_ruleset* ss_ruleset_new_default(void) {
+    try {
+        return new ss_ruleset{std::make_shared<const RuleSet>(secret_rule_definitions)};
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+ss_ruleset* ss_ruleset_new(const ss_rule_def* rules, size_t count, char* error, size_t error_size) {
+    if (!rules && count > 0) {
+        write_error(error, error_size, ss_strerror(SS_ERR_INVALID_ARGUMENT));
+        return nullptr;
+    }
+    try {
+        std::vector<RuleDefinition> definitions;
+        definitions.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            if (!rules[i].name || !rules[i].pattern) {
+                write_error(error, error_size, "rule " + std::to_string(i) + ": missing name or pattern");
+                return nullptr;
+            }
+            definitions.push_back({rules[i].name, rules[i].pattern, rules[i].icase != 0});
+        }
+        try {
+            return new ss_ruleset{std::make_shared<const RuleSet>(definitions)};
+        } catch (const std::regex_error& e) {
+            write_error(error, error_size, std::string("invalid pattern: ") + e.what());
+            // name the offending rule; only paid on the error path
+            for (const auto& def : definitions) {
+                try {
+                    std::regex check(def.pattern);
+                } catch (const std::regex_error& bad) {
+                    write_error(error, error_size, "rule '" + def.name + "': " + bad.what());
+                    break;
+                }
+            }
+        }
+    } catch (const std::exception& e) {
+        write_error(error, error_size, e.what());
+    } catch (...) {
+        write_error(error, error_size, ss_strerror(SS_ERR_INTERNAL));
+    }
+    return nullptr;
+}
+
+size_t ss_ruleset_size(const ss_ruleset* ruleset) {
+    return ruleset ? ruleset->rules->size() : 0;
+}
+
+void ss_ruleset_free(ss_ruleset* ruleset) {
+    delete ruleset;
+}
+
+ss_scanner* ss_scanner_new(const ss_ruleset* ruleset) {
+    if (!ruleset) return nullptr;
+    try {
+        return new ss_scanner{CallbackScanner(ruleset->rules)};
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+int ss_scanner_set_budget_ms(ss_scanner* scanner, long long budget_ms) {
+    if (!scanner || budget_ms < 0) return SS_ERR_INVALID_ARGUMENT;
+    ScanLimits limits = scanner->scanner.get_limits();
+    limits.file_budget = std::chrono::milliseconds(budget_ms);
+    scanner->scanner.set_limits(limits);
+    return SS_OK;
+}
+
+void ss_scanner_free(ss_scanner* scanner) {
+    delete scanner;
+}
+
+int ss_scan_buffer(ss_scanner* scanner, const char* data, size_t len, const char* label,
+                   ss_finding_cb callback, void* user_data) {
+    if (!scanner || (!data && len > 0)) return SS_ERR_INVALID_ARGUMENT;
+    try {
+        return scanner->scanner.run(data ? data : "", len, label, callback, user_data);
+    } catch (...) {
+        return SS_ERR_INTERNAL;
+    }
+}
+
+int ss_scan_path(ss_scanner* scanner, const char* path, ss_finding_cb callback, void* user_data) {
+    if (!scanner || !path) return SS_ERR_INVALID_ARGUMENT;
+    try {
+        std::string content;
+        if (!scanner->scanner.read_file(path, content)) return SS_ERR_IO;
+        return scanner->scanner.run(content.data(), content.size(), path, callback, user_data);
+    } catch (...) {
+        return SS_ERR_INTERNAL;
+    }
+}
+
+} // extern "C"
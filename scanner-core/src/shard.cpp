@@ -0,0 +1,244 @@
+/**
+ * @file shard.cpp
+ * @brief Implements deterministic shard assignment and mergeable partial results.
+ *
+ * A sharded scan runs the same walk and filters on every node, then keeps only the files
+ * assigned to its shard. The assignment is a pure function of the candidate paths and
+ * sizes, so nodes agree without talking to each other as long as they scan the same tree.
+ *
+ * Partial result format (one JSON object per line):
+ * - {"shard":i,"shards":N,"root":...,"candidates":...,"total_files":...,"files_scanned":...,
+ *    "secrets_suppressed":...,"bytes":...}
+ * - one finding object per line, in the report format with a root-relative "file"
+ * - {"partial_path":...,"reason":...} for files whose scan stopped early
+ *
+ * @author Dorna Raj Gyawali <dronarajgyawali@gmail.com>
+ * @date 2025
+ */
+
+#include "shard.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <queue>
+#include <stdexcept>
+
+namespace {
+
+bool parse_size(const std::string& text, size_t& value) {
+    if (text.empty() || text.find_first_not_of("0123456789") != std::string::npos) return false;
+    try {
+        value = static_cast<size_t>(std::stoull(text));
+    } catch (const std::exception&) {
+        return false;
+    }
+    return true;
+}
+
+bool field_size(const JsonFields& fields, const char* name, size_t& value) {
+    auto it = fields.find(name);
+    return it != fields.end() && parse_size(it->second, value);
+}
+
+} // namespace
+
+ShardSpec parse_shard_spec(const std::string& value) {
+    size_t slash = value.find('/');
+    ShardSpec spec;
+    if (slash == std::string::npos || !parse_size(value.substr(0, slash), spec.index) ||
+        !parse_size(value.substr(slash + 1), spec.count) || spec.count == 0 || spec.index >= spec.count) {
+        throw std::invalid_argument("invalid value '" + value + "' for --shard (expected i/N with 0 <= i < N)");
+    }
+    return spec;
+}
+
+uint64_t shard_path_hash(std::string_view rel_path) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (unsigned char c : rel_path) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+std::vector<size_t> assign_shards(const std::vector<ShardCandidate>& candidates, size_t shard_count) {
+    shard_count = std::max<size_t>(1, shard_count);
+    std::vector<uint64_t> hashes(candidates.size());
+    std::vector<size_t> order(candidates.size());
+    for (size_t i = 0; i < candidates.size(); ++i) {
+        hashes[i] = shard_path_hash(candidates[i].rel_path);
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        if (candidates[a].size != candidates[b].size) return candidates[a].size > candidates[b].size;
+        if (hashes[a] != hashes[b]) return hashes[a] < hashes[b];
+        return candidates[a].rel_path < candidates[b].rel_path;
+    });
+
+    // least loaded shard first; equal loads go to the lower index
+    using Load = std::pair<uint64_t, size_t>;
+    std::priority_queue<Load, std::vector<Load>, std::greater<Load>> loads;
+    for (size_t s = 0; s < shard_count; ++s) loads.push({0, s});
+
+    std::vector<size_t> assignment(candidates.size());
+    for (size_t i : order) {
+        Load lightest = loads.top();
+        loads.pop();
+        assignment[i] = lightest.second;
+        // empty files still cost an open, so every file adds at least one unit
+        lightest.first += std::max<uint64_t>(1, candidates[i].size);
+        loads.push(lightest);
+    }
+    return assignment;
+}
+
+bool write_shard_partial(const std::string& file_path, const ShardPartial& partial, std::string& error,
+                         const FindingSource& findings) {
+    std::string tmp_path = file_path + ".tmp";
+    {
+        std::ofstream out(tmp_path, std::ios::trunc);
+        if (!out) {
+            error = "cannot write partial result '" + tmp_path + "'";
+            return false;
+        }
+        out << "{"
+            << R"("shard":)" << partial.shard << ","
+            << R"("shards":)" << partial.shards << ","
+            << R"("root":")" << json_escape(partial.root) << "\","
+            << R"("candidates":)" << partial.candidates << ","
+            << R"("total_files":)" << partial.total_files << ","
+            << R"("files_scanned":)" << partial.files_scanned << ","
+            << R"("secrets_suppressed":)" << partial.secrets_suppressed << ","
+            << R"("bytes":)" << partial.bytes
+            << "}\n";
+        auto write_finding = [&out](const FindingRecord& finding) { out << finding_to_json(finding) << "\n"; };
+        if (findings) {
+            if (!findings(write_finding, error)) {
+                out.close();
+                std::remove(tmp_path.c_str());
+                return false;
+            }
+        } else {
+            for (const auto& finding : partial.findings) write_finding(finding);
+        }
+        for (const auto& [path, reason] : partial.partial_files) {
+            out << R"({"partial_path":")" << json_escape(path) << R"(","reason":")" << json_escape(reason) << "\"}\n";
+        }
+        out.flush();
+        if (!out) {
+            error = "failed while writing partial result '" + tmp_path + "'";
+            return false;
+        }
+    }
+    if (std::rename(tmp_path.c_str(), file_path.c_str()) != 0) {
+        error = "cannot replace partial result '" + file_path + "'";
+        std::remove(tmp_path.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool read_shard_partial(const std::string& file_path, ShardPartial& partial, std::string& error,
+                        const FindingSink& on_finding) {
+    std::ifstream in(file_path);
+    if (!in) {
+        error = "cannot read partial result '" + file_path + "'";
+        return false;
+    }
+    partial = ShardPartial{};
+    std::string line;
+    size_t line_number = 0;
+    bool have_header = false;
+    while (std::getline(in, line)) {
+        ++line_number;
+        if (line.empty()) continue;
+        JsonFields fields;
+        auto bad_line = [&] {
+            error = file_path + ":" + std::to_string(line_number) + ": malformed partial result line";
+            return false;
+        };
+        if (!parse_json_object(line, fields)) return bad_line();
+
+        if (!have_header) {
+            if (!field_size(fields, "shard", partial.shard) || !field_size(fields, "shards", partial.shards) ||
+                !field_size(fields, "candidates", partial.candidates) ||
+                !field_size(fields, "total_files", partial.total_files) ||
+                !field_size(fields, "files_scanned", partial.files_scanned) ||
+                !field_size(fields, "secrets_suppressed", partial.secrets_suppressed) ||
+                !fields.count("root") || partial.shard >= partial.shards) {
+                error = "'" + file_path + "' is not a shard partial result";
+                return false;
+            }
+            size_t bytes = 0;
+            field_size(fields, "bytes", bytes);
+            partial.bytes = bytes;
+            partial.root = fields["root"];
+            have_header = true;
+        } else if (fields.count("partial_path")) {
+            partial.partial_files.emplace_back(fields["partial_path"], fields["reason"]);
+        } else {
+            FindingRecord finding;
+            size_t line_no = 0, column = 0;
+            if (!fields.count("file") || !field_size(fields, "line", line_no) ||
+                !field_size(fields, "column", column) || !field_size(fields, "offset", finding.offset)) {
+                return bad_line();
+            }
+            finding.file = fields["file"];
+            finding.line = static_cast<int>(line_no);
+            finding.column = static_cast<int>(column);
+            finding.type = fields["type"];
+            finding.match = fields["match"];
+            if (on_finding) {
+                on_finding(std::move(finding));
+            } else {
+                partial.findings.push_back(std::move(finding));
+            }
+        }
+    }
+    if (!have_header) {
+        error = "'" + file_path + "' is empty";
+        return false;
+    }
+    return true;
+}
+
+bool merge_shard_partials(const std::vector<ShardPartial>& partials, ShardPartial& merged, std::string& error) {
+    if (partials.empty()) {
+        error = "no partial results to merge";
+        return false;
+    }
+    const size_t shards = partials.front().shards;
+    std::vector<bool> seen(shards, false);
+    merged = ShardPartial{};
+    merged.shards = shards;
+    merged.root = partials.front().root;
+    merged.candidates = partials.front().candidates;
+    for (const auto& partial : partials) {
+        if (partial.shards != shards || partial.candidates != merged.candidates) {
+            error = "partial results come from different scans";
+            return false;
+        }
+        if (seen[partial.shard]) {
+            error = "shard " + std::to_string(partial.shard) + " appears more than once";
+            return false;
+        }
+        seen[partial.shard] = true;
+        merged.total_files += partial.total_files;
+        merged.files_scanned += partial.files_scanned;
+        merged.secrets_suppressed += partial.secrets_suppressed;
+        merged.bytes += partial.bytes;
+        merged.findings.insert(merged.findings.end(), partial.findings.begin(), partial.findings.end());
+        merged.partial_files.insert(merged.partial_files.end(), partial.partial_files.begin(),
+                                    partial.partial_files.end());
+    }
+    for (size_t s = 0; s < shards; ++s) {
+        if (!seen[s]) {
+            error = "shard " + std::to_string(s) + " of " + std::to_string(shards) + " is missing";
+            return false;
+        }
+    }
+    std::sort(merged.findings.begin(), merged.findings.end(), finding_less);
+    std::sort(merged.partial_files.begin(), merged.partial_files.end());
+    return true;
+}
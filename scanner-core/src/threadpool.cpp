@@ -8,7 +8,7 @@
  *
  * Features:
  * - Creation and management of worker threads.
- * - Thread-safe task queue.
+ * - Thread-safe task queue, optionally bounded so producers block instead of growing it.
  * - Graceful shutdown and joining of threads.
  *
  * @author Dorna Raj Gyawali <dronarajgyawali@gmail.com>
@@ -17,7 +17,7 @@
 
 #include "threadpool.h"
 
-ThreadPool::ThreadPool(size_t threads) : stop(false) {
+ThreadPool::ThreadPool(size_t threads, size_t max_queued_) : max_queued(max_queued_), stop(false) {
     for (size_t i = 0; i < threads; ++i) {
         workers.emplace_back([this] {
             for (;;) {
@@ -31,6 +31,7 @@ ThreadPool::ThreadPool(size_t threads) : stop(false) {
                     task = std::move(this->tasks.front());
                     this->tasks.pop();
                 }
+                this->space_available.notify_one();
 
                 task();
             }
@@ -44,6 +45,7 @@ ThreadPool::~ThreadPool() {
         stop = true;
     }
     condition.notify_all();
+    space_available.notify_all();
     for (std::thread &worker : workers)
         worker.join();
 }
@@ -0,0 +1,221 @@
+/**
+ * @file watcher.cpp
+ * @brief Implements the DirectoryWatcher class for incremental rescans.
+ *
+ * One inotify instance holds a watch per directory. Events are folded into a map from
+ * path to its last known change, so a file that is written several times, or deleted and
+ * recreated, is reported once with its final state. A self-pipe lets another thread wake
+ * a watcher that is blocked in poll.
+ *
+ * Features:
+ * - Recursive watches that skip directories excluded by the PathFilter.
+ * - New directories are watched on creation and their files reported as changed.
+ * - Bursts of events are coalesced until the tree has been quiet for a moment.
+ * - Queue overflows are surfaced so the caller can fall back to a full rescan.
+ *
+ * @author Dorna Raj Gyawali <dronarajgyawali@gmail.com>
+ * @date 2025
+ */
+
+#include "watcher.h"
+#include <algorithm>
+#include <cerrno>
+#include <filesystem>
+#include <system_error>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+#ifdef __linux__
+constexpr uint32_t WATCH_MASK = IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_CREATE | IN_DELETE |
+                                IN_DELETE_SELF | IN_ONLYDIR | IN_DONT_FOLLOW;
+#endif
+
+} // namespace
+
+DirectoryWatcher::DirectoryWatcher(const PathFilter& filter_) : filter(filter_) {}
+
+DirectoryWatcher::~DirectoryWatcher() {
+    if (inotify_fd >= 0) close(inotify_fd);
+    if (wake_pipe[0] >= 0) close(wake_pipe[0]);
+    if (wake_pipe[1] >= 0) close(wake_pipe[1]);
+}
+
+bool DirectoryWatcher::start(const std::string& root, std::string& error) {
+#ifdef __linux__
+    root_dir = root;
+    root_prefix_len = root.size() + (!root.empty() && root.back() == '/' ? 0 : 1);
+    inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotify_fd < 0) {
+        error = "cannot create an inotify instance";
+        return false;
+    }
+    if (pipe(wake_pipe) != 0) {
+        error = "cannot create the watcher wake-up pipe";
+        return false;
+    }
+    fcntl(wake_pipe[0], F_SETFL, O_NONBLOCK);
+    add_tree(root, false);
+    if (dirs.empty()) {
+        error = "cannot watch '" + root + "'";
+        return false;
+    }
+    return true;
+#else
+    (void)root;
+    error = "watch mode needs inotify and is only available on Linux";
+    return false;
+#endif
+}
+
+void DirectoryWatcher::stop() {
+    if (wake_pipe[1] >= 0) {
+        char byte = 1;
+        ssize_t ignored = write(wake_pipe[1], &byte, 1);
+        (void)ignored;
+    }
+}
+
+void DirectoryWatcher::add_tree(const std::string& dir, bool report_files) {
+#ifdef __linux__
+    int wd = inotify_add_watch(inotify_fd, dir.c_str(), WATCH_MASK);
+    if (wd < 0) return;
+    dirs[wd] = dir;
+
+    // files created before the watch existed would otherwise be missed
+    std::error_code ec;
+    for (fs::directory_iterator it(dir, ec), end; !ec && it != end; it.increment(ec)) {
+        const std::string path = it->path().string();
+        std::error_code type_ec;
+        if (it->is_directory(type_ec) && !it->is_symlink(type_ec)) {
+            if (!filter.is_excluded_dir(std::string_view(path).substr(root_prefix_len))) {
+                add_tree(path, report_files);
+            }
+        } else if (report_files && it->is_regular_file(type_ec)) {
+            pending[path] = Change::modified;
+        }
+    }
+#else
+    (void)dir;
+    (void)report_files;
+#endif
+}
+
+void DirectoryWatcher::forget_tree(const std::string& dir) {
+#ifdef __linux__
+    const std::string prefix = dir + "/";
+    for (auto it = dirs.begin(); it != dirs.end();) {
+        if (it->second == dir || it->second.compare(0, prefix.size(), prefix) == 0) {
+            inotify_rm_watch(inotify_fd, it->first);
+            it = dirs.erase(it);
+        } else {
+            ++it;
+        }
+    }
+#else
+    (void)dir;
+#endif
+}
+
+// drains the inotify queue into pending; false on a read error
+bool DirectoryWatcher::read_events() {
+#ifdef __linux__
+    alignas(inotify_event) char buffer[64 * 1024];
+    for (;;) {
+        ssize_t length = read(inotify_fd, buffer, sizeof(buffer));
+        if (length < 0) return errno == EAGAIN || errno == EINTR;
+        if (length == 0) return true;
+
+        for (ssize_t pos = 0; pos < length;) {
+            const auto* event = reinterpret_cast<const inotify_event*>(buffer + pos);
+            pos += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+
+            if (event->mask & IN_Q_OVERFLOW) {
+                pending[std::string()] = Change::modified;
+                continue;
+            }
+            if (event->mask & IN_IGNORED) {
+                dirs.erase(event->wd);
+                continue;
+            }
+            auto dir = dirs.find(event->wd);
+            if (dir == dirs.end() || event->len == 0) continue;
+            std::string path = dir->second + "/" + event->name;
+
+            if (event->mask & IN_ISDIR) {
+                if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+                    if (!filter.is_excluded_dir(std::string_view(path).substr(root_prefix_len))) {
+                        add_tree(path, true);
+                    }
+                } else if (event->mask & (IN_DELETE | IN_MOVED_FROM)) {
+                    forget_tree(path);
+                    pending[path] = Change::removed;
+                }
+            } else if (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) {
+                pending[path] = Change::modified;
+            } else if (event->mask & (IN_DELETE | IN_MOVED_FROM)) {
+                pending[path] = Change::removed;
+            }
+        }
+    }
+#else
+    return false;
+#endif
+}
+
+bool DirectoryWatcher::next_batch(WatchBatch& batch, std::chrono::milliseconds quiet,
+                                  std::chrono::milliseconds max_delay) {
+    batch = WatchBatch{};
+    if (inotify_fd < 0) return false;
+
+    pollfd fds[2] = {{inotify_fd, POLLIN, 0}, {wake_pipe[0], POLLIN, 0}};
+    Clock::time_point first_event{};
+    bool collecting = false;
+    while (true) {
+        int timeout = -1;
+        if (collecting) {
+            auto left = max_delay - std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - first_event);
+            timeout = static_cast<int>(std::max<long long>(0, std::min(quiet, left).count()));
+        }
+        int ready = poll(fds, 2, timeout);
+        if (ready < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        if (fds[1].revents) return false;
+        if (ready == 0) {
+            // the tree has been quiet long enough, or the burst hit max_delay
+            if (!pending.empty()) break;
+            collecting = false;
+            continue;
+        }
+        if (!read_events()) return false;
+        if (!collecting && !pending.empty()) {
+            collecting = true;
+            first_event = Clock::now();
+        }
+        if (collecting && Clock::now() - first_event >= max_delay) break;
+    }
+
+    for (auto& [path, change] : pending) {
+        if (path.empty()) {
+            batch.overflow = true;
+        } else if (change == Change::modified) {
+            batch.changed.push_back(path);
+        } else {
+            batch.removed.push_back(path);
+        }
+    }
+    pending.clear();
+    return true;
+}
@@ -0,0 +1,69 @@
+#include <gtest/gtest.h>
+#include <fstream>
+#include <filesystem>
+#include "baseline.h"
+
+namespace fs = std::filesystem;
+
+class BaselineTest : public ::testing::Test {
+protected:
+    std::string path = (fs::temp_directory_path() / "secret_scanner_test.baseline").string();
+
+    void TearDown() override {
+        fs::remove(path);
+    }
+};
+
+TEST(FingerprintTest, IsStableUnderWhitespaceAndPathPrefix) {
+    uint64_t a = finding_fingerprint("Password in Env", "password = 'hunter2hunter2'", "src/config.py");
+    EXPECT_EQ(a, finding_fingerprint("Password in Env", "  password  =\t'hunter2hunter2' ", "./src/config.py"));
+    EXPECT_NE(a, finding_fingerprint("Generic Secret", "password = 'hunter2hunter2'", "src/config.py"));
+    EXPECT_NE(a, finding_fingerprint("Password in Env", "password = 'hunter3hunter3'", "src/config.py"));
+    EXPECT_NE(a, finding_fingerprint("Password in Env", "password = 'hunter2hunter2'", "src/other.py"));
+    EXPECT_NE(a, 0u);
+}
+
+TEST_F(BaselineTest, WritesAndLooksUpFingerprints) {
+    std::vector<uint64_t> fingerprints;
+    for (uint64_t i = 1; i <= 1000; ++i) {
+        fingerprints.push_back(finding_fingerprint("AWS Access Key", "AKIA" + std::to_string(i), "a.py"));
+    }
+    fingerprints.push_back(fingerprints.front());
+
+    std::string error;
+    ASSERT_TRUE(Baseline::write(path, fingerprints, error)) << error;
+
+    Baseline baseline;
+    ASSERT_TRUE(baseline.load(path, error)) << error;
+    EXPECT_EQ(baseline.size(), 1000u);
+    for (uint64_t fp : fingerprints) {
+        EXPECT_TRUE(baseline.contains(fp));
+    }
+    EXPECT_FALSE(baseline.contains(finding_fingerprint("AWS Access Key", "AKIA0", "a.py")));
+    EXPECT_FALSE(baseline.contains(0));
+}
+
+TEST_F(BaselineTest, EmptyBaselineContainsNothing) {
+    std::string error;
+    ASSERT_TRUE(Baseline::write(path, {}, error)) << error;
+    Baseline baseline;
+    ASSERT_TRUE(baseline.load(path, error)) << error;
+    EXPECT_EQ(baseline.size(), 0u);
+    EXPECT_FALSE(baseline.contains(42));
+}
+
+TEST_F(BaselineTest, RejectsMissingAndCorruptFiles) {
+    Baseline baseline;
+    std::string error;
+    EXPECT_FALSE(baseline.load(path, error));
+    EXPECT_FALSE(error.empty());
+
+    {
+        std::ofstream ofs(path, std::ios::binary);
+        ofs << "this is not a baseline file at all";
+    }
+    error.clear();
+    EXPECT_FALSE(baseline.load(path, error));
+    EXPECT_NE(error.find("not a valid baseline"), std::string::npos);
+    EXPECT_FALSE(baseline.contains(1));
+}
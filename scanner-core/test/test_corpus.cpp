@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <set>
+#include <sstream>
+#include "corpus.h"
+#include "scanner.h"
+#include "regexpattern.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+std::string read_all(const fs::path& path) {
+    std::ifstream in(path, std::ios::binary);
+    std::stringstream ss;
+    ss << in.rdbuf();
+    return ss.str();
+}
+
+CorpusConfig small_config(uint32_t seed) {
+    CorpusConfig config;
+    config.seed = seed;
+    config.files = 80;
+    config.size_scale = 0.1;
+    config.minified_share = 0.05;
+    return config;
+}
+
+class CorpusTest : public ::testing::Test {
+protected:
+    fs::path base = fs::temp_directory_path() / "secret_scanner_corpus_test";
+
+    void SetUp() override { fs::remove_all(base); }
+    void TearDown() override { fs::remove_all(base); }
+};
+
+} // namespace
+
+TEST_F(CorpusTest, SameSeedWritesTheSameTree) {
+    Corpus first, second, other;
+    std::string error;
+    ASSERT_TRUE(generate_corpus((base / "a").string(), small_config(7), first, error)) << error;
+    ASSERT_TRUE(generate_corpus((base / "b").string(), small_config(7), second, error)) << error;
+    ASSERT_TRUE(generate_corpus((base / "c").string(), small_config(8), other, error)) << error;
+
+    ASSERT_EQ(first.files.size(), 80u);
+    ASSERT_EQ(first.files.size(), second.files.size());
+    for (size_t i = 0; i < first.files.size(); ++i) {
+        EXPECT_EQ(first.files[i].rel_path, second.files[i].rel_path);
+        EXPECT_EQ(read_all(base / "a" / first.files[i].rel_path), read_all(base / "b" / second.files[i].rel_path));
+    }
+    ASSERT_EQ(first.secrets.size(), second.secrets.size());
+    for (size_t i = 0; i < first.secrets.size(); ++i) EXPECT_EQ(first.secrets[i].text, second.secrets[i].text);
+    EXPECT_NE(first.secrets[0].text, other.secrets[0].text);
+
+    // an existing tree is never overwritten
+    EXPECT_FALSE(generate_corpus((base / "a").string(), small_config(7), first, error));
+}
+
+TEST_F(CorpusTest, EveryRuleFindsItsPlantedSecrets) {
+    Corpus corpus;
+    std::string error;
+    ASSERT_TRUE(generate_corpus(base.string(), small_config(3), corpus, error)) << error;
+
+    auto rules = std::make_shared<const RuleSet>(secret_rule_definitions);
+    SecretScanner scanner({}, {}, rules);
+    std::set<std::string> planted_rules;
+    for (const auto& secret : corpus.secrets) {
+        if (secret.placement != CorpusPlacement::scanned) continue;
+        planted_rules.insert(secret.rule);
+
+        FindingBuffer out;
+        scanner.scan_buffer(read_all(base / secret.rel_path), 0, out, secret.rel_path);
+        bool found = false;
+        for (const Finding& f : out) {
+            found = found || (rules->rules()[f.rule].name == secret.rule && out.text(f) == secret.text);
+        }
+        EXPECT_TRUE(found) << secret.rule << " in " << secret.rel_path << ": " << secret.text;
+    }
+    std::set<std::string> rule_names;
+    for (const auto& definition : secret_rule_definitions) rule_names.insert(definition.name);
+    EXPECT_EQ(planted_rules, rule_names);
+}
@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include "metrics.h"
+#include "pipeline.h"
+#include "regexpattern.h"
+
+namespace fs = std::filesystem;
+
+TEST(MetricsTest, RegistersEachSeriesOnce) {
+    MetricsRegistry metrics;
+    Counter& a = metrics.counter("scanner_files_skipped_total", "Skipped files", {{"reason", "filter"}});
+    Counter& b = metrics.counter("scanner_files_skipped_total", "Skipped files", {{"reason", "gitignore"}});
+    EXPECT_NE(&a, &b);
+    EXPECT_EQ(&a, &metrics.counter("scanner_files_skipped_total", "", {{"reason", "filter"}}));
+    EXPECT_THROW(metrics.gauge("scanner_files_skipped_total", ""), std::invalid_argument);
+}
+
+TEST(MetricsTest, WritesPrometheusTextFormat) {
+    MetricsRegistry metrics;
+    metrics.counter("scanner_bytes_read_total", "Bytes read").add(4096);
+    metrics.gauge("scanner_queue_depth", "Queued items", {{"queue", "paths"}}).set(3);
+    Histogram& h = metrics.histogram("scanner_stage_duration_seconds", "Stage time", {{"stage", "read"}});
+    h.observe(std::chrono::microseconds(50));
+    h.observe(std::chrono::milliseconds(2));
+    h.observe(std::chrono::seconds(20));
+
+    std::ostringstream out;
+    metrics.write_prometheus(out);
+    std::string text = out.str();
+    EXPECT_NE(text.find("# TYPE scanner_bytes_read_total counter\nscanner_bytes_read_total 4096\n"), std::string::npos);
+    EXPECT_NE(text.find("scanner_queue_depth{queue=\"paths\"} 3\n"), std::string::npos);
+    EXPECT_NE(text.find("scanner_stage_duration_seconds_bucket{stage=\"read\",le=\"0.0001\"} 1\n"), std::string::npos);
+    EXPECT_NE(text.find("scanner_stage_duration_seconds_bucket{stage=\"read\",le=\"0.0025\"} 2\n"), std::string::npos);
+    EXPECT_NE(text.find("scanner_stage_duration_seconds_bucket{stage=\"read\",le=\"+Inf\"} 3\n"), std::string::npos);
+    EXPECT_NE(text.find("scanner_stage_duration_seconds_count{stage=\"read\"} 3\n"), std::string::npos);
+    EXPECT_NE(text.find("scanner_stage_duration_seconds_sum{stage=\"read\"} 20.00205\n"), std::string::npos);
+}
+
+TEST(MetricsTest, HistogramQuantiles) {
+    Histogram h({0.001, 0.01, 0.1});
+    for (int i = 0; i < 90; ++i) h.observe(std::chrono::microseconds(500));
+    for (int i = 0; i < 10; ++i) h.observe(std::chrono::milliseconds(50));
+    EXPECT_LE(h.quantile(0.5), 0.001);
+    EXPECT_GT(h.quantile(0.99), 0.01);
+    EXPECT_LE(h.quantile(0.99), 0.1);
+    EXPECT_EQ(Histogram().quantile(0.5), 0.0);
+}
+
+TEST(MetricsTest, ExporterWritesFileAtStop) {
+    std::string path = (fs::temp_directory_path() / "secret_scanner_metrics.prom").string();
+    MetricsRegistry metrics;
+    Counter& files = metrics.counter("scanner_files_scanned_total", "Files");
+    int refreshed = 0;
+    {
+        MetricsExporter exporter(metrics, path, std::chrono::milliseconds(0), [&] { ++refreshed; });
+        files.add(7);
+        std::string error;
+        EXPECT_TRUE(exporter.stop(error)) << error;
+    }
+    EXPECT_EQ(refreshed, 1);
+    std::ifstream in(path);
+    std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    EXPECT_NE(text.find("scanner_files_scanned_total 7\n"), std::string::npos);
+    fs::remove(path);
+}
+
+TEST(MetricsTest, PipelineRecordsStageMetrics) {
+    fs::path dir = fs::temp_directory_path() / "secret_scanner_metrics_test";
+    fs::create_directories(dir);
+    std::ofstream(dir / "a.py") << "x = 1\n";
+    std::ofstream(dir / "b.py") << "y = 2\n";
+
+    class QuietScanner : public SecretScanner {
+    public:
+        QuietScanner() : SecretScanner({}, {}, secret_patterns) {}
+        void report_secret(const std::string&, int, int, size_t, const std::string&, const std::string&) const override {}
+    } scanner;
+
+    MetricsRegistry metrics;
+    PipelineConfig config;
+    config.matchers = 2;
+    config.metrics = &metrics;
+    ScanPipeline pipeline(scanner, config);
+    pipeline.submit((dir / "a.py").string());
+    pipeline.submit((dir / "b.py").string());
+    pipeline.submit((dir / "missing.py").string());
+    pipeline.finish();
+    pipeline.sample_metrics();
+
+    EXPECT_EQ(metrics.counter("scanner_files_scanned_total", "").value(), 2u);
+    EXPECT_EQ(metrics.counter("scanner_files_unreadable_total", "").value(), 1u);
+    EXPECT_EQ(metrics.counter("scanner_bytes_read_total", "").value(), 12u);
+    EXPECT_EQ(metrics.histogram("scanner_stage_duration_seconds", "", {{"stage", "match"}}).count(), 2u);
+    EXPECT_EQ(metrics.gauge("scanner_workers", "", {{"stage", "match"}}).value(), 2.0);
+    EXPECT_EQ(metrics.gauge("scanner_queue_depth", "", {{"queue", "paths"}}).value(), 0.0);
+
+    std::ostringstream json;
+    metrics.write_json(json);
+    EXPECT_NE(json.str().find("\"scanner_files_scanned_total\":{\"type\":\"counter\""), std::string::npos);
+    EXPECT_NE(json.str().find("\"labels\":{\"stage\":\"match\"},\"count\":2"), std::string::npos);
+    fs::remove_all(dir);
+}
@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+#include <fstream>
+#include <filesystem>
+#include "pathfilter.h"
+
+namespace fs = std::filesystem;
+
+TEST(PathFilterTest, EmptyFilterMatchesNothing) {
+    PathFilter filter;
+    EXPECT_TRUE(filter.empty());
+    EXPECT_FALSE(filter.match("src/app.py", false).excluded);
+    EXPECT_TRUE(filter.selects_file("src/app.py", true));
+    EXPECT_FALSE(filter.selects_file("Dockerfile", false));
+}
+
+TEST(PathFilterTest, IgnoredDirsExcludeAtAnyDepth) {
+    PathFilter filter = PathFilter::from_ignored_dirs({"node_modules", ".git"});
+    EXPECT_TRUE(filter.is_excluded_dir("node_modules"));
+    EXPECT_TRUE(filter.is_excluded_dir("web/app/node_modules"));
+    EXPECT_FALSE(filter.is_excluded_dir("web/app"));
+    EXPECT_FALSE(filter.selects_file("web/node_modules/pkg/index.js", true));
+    // directory-only patterns do not exclude a file with the same name
+    EXPECT_TRUE(filter.selects_file("docs/node_modules", true));
+}
+
+TEST(PathFilterTest, IncludesSelectFilesWithoutExtension) {
+    PathFilter filter;
+    filter.add_include("Dockerfile");
+    filter.add_include(".env.*");
+    EXPECT_TRUE(filter.selects_file("Dockerfile", false));
+    EXPECT_TRUE(filter.selects_file("services/api/Dockerfile", false));
+    EXPECT_TRUE(filter.selects_file("config/.env.production", false));
+    EXPECT_FALSE(filter.selects_file("Makefile", false));
+}
+
+TEST(PathFilterTest, GlobstarAndAnchoredPatterns) {
+    PathFilter filter;
+    filter.add_exclude("**/fixtures/**");
+    filter.add_exclude("/vendor");
+    filter.add_exclude("docs/*.md");
+    EXPECT_FALSE(filter.selects_file("test/fixtures/keys.json", true));
+    EXPECT_FALSE(filter.selects_file("a/b/fixtures/c/d.py", true));
+    EXPECT_FALSE(filter.selects_file("vendor/lib.go", true));
+    EXPECT_TRUE(filter.selects_file("src/vendor/lib.go", true));
+    EXPECT_FALSE(filter.selects_file("docs/guide.md", true));
+    EXPECT_TRUE(filter.selects_file("docs/api/guide.md", true));
+}
+
+TEST(PathFilterTest, WildcardsWithinComponent) {
+    PathFilter filter;
+    filter.add_exclude("*.min.js");
+    filter.add_exclude("test_?.py");
+    filter.add_exclude("data[0-9].json");
+    EXPECT_FALSE(filter.selects_file("static/app.min.js", true));
+    EXPECT_TRUE(filter.selects_file("static/app.js", true));
+    EXPECT_FALSE(filter.selects_file("test_a.py", true));
+    EXPECT_TRUE(filter.selects_file("test_ab.py", true));
+    EXPECT_FALSE(filter.selects_file("data7.json", true));
+    EXPECT_TRUE(filter.selects_file("datax.json", true));
+}
+
+TEST(PathFilterTest, ExcludeWinsOverInclude) {
+    PathFilter filter;
+    filter.add_include(".env");
+    filter.add_exclude("examples/");
+    auto m = filter.match("examples/.env", false);
+    EXPECT_TRUE(m.included);
+    EXPECT_TRUE(m.excluded);
+    EXPECT_FALSE(filter.selects_file("examples/.env", false));
+}
+
+TEST(PathFilterTest, LoadsIgnoreFile) {
+    fs::path file = fs::temp_directory_path() / "secret_scanner_test_ignore";
+    {
+        std::ofstream ofs(file);
+        ofs << "# comment\n\nsnapshots/\n*.lock\r\n!*.pem\n";
+    }
+    PathFilter filter;
+    EXPECT_TRUE(filter.load_ignore_file(file.string()));
+    EXPECT_FALSE(filter.selects_file("ui/snapshots/a.json", true));
+    EXPECT_FALSE(filter.selects_file("yarn.lock", true));
+    EXPECT_TRUE(filter.selects_file("certs/server.pem", false));
+    EXPECT_FALSE(filter.load_ignore_file((file.string() + ".missing")));
+    fs::remove(file);
+}
@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include "pathlist.h"
+
+namespace {
+
+std::vector<std::string> split(const std::vector<std::string>& chunks,
+                               PathListSplitter::Separator separator = PathListSplitter::Separator::detect) {
+    std::vector<std::string> paths;
+    auto collect = [&paths](std::string_view path) { paths.emplace_back(path); };
+    PathListSplitter splitter(separator);
+    for (const auto& chunk : chunks) splitter.feed(chunk, collect);
+    splitter.finish(collect);
+    return paths;
+}
+
+} // namespace
+
+TEST(PathListTest, DetectsNulSeparatedLists) {
+    using namespace std::string_literals;
+    std::vector<std::string> paths = split({"src/a.cpp\0src/new\nline.txt\0"s, "b.env\0"s});
+    EXPECT_EQ(paths, (std::vector<std::string>{"src/a.cpp", "src/new\nline.txt", "b.env"}));
+}
+
+TEST(PathListTest, DetectsNewlineSeparatedLists) {
+    std::vector<std::string> paths = split({"a.txt\r\n\nb.txt\n", "c.txt"});
+    EXPECT_EQ(paths, (std::vector<std::string>{"a.txt", "b.txt", "c.txt"}));
+}
+
+TEST(PathListTest, ReassemblesPathsSplitAcrossChunks) {
+    using namespace std::string_literals;
+    // the separator is only seen in the third chunk
+    std::vector<std::string> paths = split({"very/long/pa", "th/to/fi", "le.txt\0sec"s, "ond.txt"});
+    EXPECT_EQ(paths, (std::vector<std::string>{"very/long/path/to/file.txt", "second.txt"}));
+
+    std::string list;
+    for (int i = 0; i < 1000; ++i) list += "dir/file" + std::to_string(i) + ".txt\n";
+    std::vector<std::string> chunks;
+    for (size_t i = 0; i < list.size(); i += 7) chunks.push_back(list.substr(i, 7));
+    paths = split(chunks);
+    ASSERT_EQ(paths.size(), 1000u);
+    EXPECT_EQ(paths[999], "dir/file999.txt");
+}
+
+TEST(PathListTest, ExplicitSeparatorKeepsTheOther) {
+    using namespace std::string_literals;
+    std::vector<std::string> paths = split({"a\nb\0c"s}, PathListSplitter::Separator::nul);
+    EXPECT_EQ(paths, (std::vector<std::string>{"a\nb", "c"}));
+}
+
+TEST(PathListTest, ReportsPathsBeforeThePipeIsClosed) {
+    int fds[2];
+    ASSERT_EQ(pipe(fds), 0);
+    ASSERT_EQ(write(fds[1], "first.txt\n", 10), 10);
+
+    std::vector<std::string> paths;
+    bool ok = read_path_list(fds[0], [&](std::string_view path) {
+        paths.emplace_back(path);
+        if (paths.size() == 1) {
+            // only closed here, so the read would never end if paths waited for end of input
+            EXPECT_EQ(write(fds[1], "second.txt\n", 11), 11);
+            close(fds[1]);
+        }
+    });
+    EXPECT_TRUE(ok);
+    EXPECT_EQ(paths, (std::vector<std::string>{"first.txt", "second.txt"}));
+    close(fds[0]);
+}
+
+TEST(PathListTest, RootRelativeOffsetLeavesPathsOutsideTheRoot) {
+    EXPECT_EQ(root_relative_offset("/work/repo/src/a.py", "/work/repo"), 11u);
+    EXPECT_EQ(root_relative_offset("/work/repo/src/a.py", "/work/repo/"), 11u);
+    EXPECT_EQ(root_relative_offset("/etc/passwd", "/"), 1u);
+    // shorter than the root: taking the root's length would run past the end
+    EXPECT_EQ(root_relative_offset("/tmp/a.py", "/tmp/sstest/deep/project/root"), 0u);
+    // longer but outside, or sharing only a name prefix with the root
+    EXPECT_EQ(root_relative_offset("/elsewhere/with/a/much/longer/path.py", "/work/repo"), 0u);
+    EXPECT_EQ(root_relative_offset("/work/repository/a.py", "/work/repo"), 0u);
+    EXPECT_EQ(root_relative_offset("/work/repo", "/work/repo"), 0u);
+    EXPECT_EQ(root_relative_offset("a.py", ""), 0u);
+}
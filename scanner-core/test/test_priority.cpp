@@ -0,0 +1,45 @@
+#include <gtest/gtest.h>
+#include "priority.h"
+
+TEST(RiskScoreTest, SecretFilesOutrankConfigAndSource) {
+    const double week_old = 8;
+    int env = risk_score(".env", 200, week_old);
+    int env_local = risk_score("web/.env.local", 200, week_old);
+    int key = risk_score("certs/server.pem", 2000, week_old);
+    int named = risk_score("src/aws_credentials_loader.py", 2000, week_old);
+    int config = risk_score("app/settings.yaml", 2000, week_old);
+    int source = risk_score("src/main.py", 2000, week_old);
+
+    EXPECT_GT(env, named);
+    EXPECT_GT(env_local, named);
+    EXPECT_GT(key, named);
+    EXPECT_GT(named, config);
+    EXPECT_GT(config, source);
+    EXPECT_EQ(risk_score("APP/.ENV", 200, week_old), env);
+}
+
+TEST(RiskScoreTest, RecentSmallAndConfigDirectoryFilesScoreHigher) {
+    EXPECT_GT(risk_score("src/a.py", 100, 0.5), risk_score("src/a.py", 100, 90));
+    EXPECT_GT(risk_score("src/a.py", 100, 90), risk_score("src/a.py", 5 * 1024 * 1024, 90));
+    EXPECT_GT(risk_score("deploy/values.txt", 100, 90), risk_score("docs/values.txt", 100, 90));
+    // an unknown age gets neither a bonus nor a penalty
+    EXPECT_EQ(risk_score("src/a.py", 100, -1), risk_score("src/a.py", 100, 90));
+}
+
+TEST(RiskOrderTest, SortsHighestRiskFirstWithPathTiebreak) {
+    std::vector<RiskCandidate> candidates = {
+        {"/repo/src/b.py", 6, 2000, 90, 0},
+        {"/repo/src/a.py", 6, 2000, 90, 0},
+        {"/repo/config/.env", 6, 100, 0.1, 0},
+        {"/repo/big.min.js", 6, 8 * 1024 * 1024, 90, 0},
+        {"/repo/id_rsa", 6, 1700, 400, 0},
+    };
+    order_by_risk(candidates);
+    ASSERT_EQ(candidates.size(), 5u);
+    EXPECT_EQ(candidates[0].path, "/repo/config/.env");
+    EXPECT_EQ(candidates[1].path, "/repo/id_rsa");
+    EXPECT_EQ(candidates[2].path, "/repo/src/a.py");
+    EXPECT_EQ(candidates[3].path, "/repo/src/b.py");
+    EXPECT_EQ(candidates[4].path, "/repo/big.min.js");
+    EXPECT_GE(candidates[0].score, candidates[1].score);
+}
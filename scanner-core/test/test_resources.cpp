@@ -0,0 +1,177 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include "resources.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// a fake /sys/fs/cgroup and /proc/self/cgroup under a temporary directory
+class CgroupTree {
+public:
+    explicit CgroupTree(const std::string& name) : dir(fs::temp_directory_path() / name) {
+        fs::remove_all(dir);
+        fs::create_directories(dir / "sys");
+    }
+    ~CgroupTree() { fs::remove_all(dir); }
+
+    void write(const std::string& rel_path, const std::string& content) const {
+        fs::path path = dir / "sys" / rel_path;
+        fs::create_directories(path.parent_path());
+        std::ofstream(path) << content << "\n";
+    }
+    void proc(const std::string& content) const { std::ofstream(dir / "cgroup") << content; }
+
+    ResourceLimits read() const { return read_resource_limits((dir / "sys").string(), (dir / "cgroup").string()); }
+
+private:
+    fs::path dir;
+};
+
+} // namespace
+
+TEST(ResourceLimitsTest, ReadsTheTightestV2LimitUpTheHierarchy) {
+    CgroupTree tree("secret_scanner_cgroup_v2");
+    tree.write("cgroup.controllers", "cpu memory");
+    tree.write("kubepods/cpu.max", "400000 100000");
+    tree.write("kubepods/memory.max", "max");
+    tree.write("kubepods/pod1/cpu.max", "max 100000");
+    tree.write("kubepods/pod1/memory.max", "2147483648");
+    tree.write("kubepods/pod1/memory.high", "1073741824");
+    tree.proc("0::/kubepods/pod1\n");
+
+    ResourceLimits limits = tree.read();
+    EXPECT_EQ(limits.cgroup_version, 2);
+    EXPECT_DOUBLE_EQ(limits.cpu_quota, 4.0);
+    EXPECT_EQ(limits.memory_limit, 1073741824u);
+}
+
+TEST(ResourceLimitsTest, NamespacedCgroupFallsBackToTheMount) {
+    CgroupTree tree("secret_scanner_cgroup_ns");
+    tree.write("cgroup.controllers", "cpu memory");
+    tree.write("cpu.max", "250000 100000");
+    tree.write("memory.max", "536870912");
+    // a cgroup namespace shows "/", an older runtime the host path that is not mounted here
+    tree.proc("0::/system.slice/docker-abc.scope\n");
+
+    ResourceLimits limits = tree.read();
+    EXPECT_EQ(limits.cgroup_version, 2);
+    EXPECT_DOUBLE_EQ(limits.cpu_quota, 2.5);
+    EXPECT_EQ(limits.memory_limit, 536870912u);
+}
+
+TEST(ResourceLimitsTest, ReadsV1ControllersAndIgnoresUnlimitedValues) {
+    CgroupTree tree("secret_scanner_cgroup_v1");
+    tree.write("cpu,cpuacct/docker/abc/cpu.cfs_quota_us", "150000");
+    tree.write("cpu,cpuacct/docker/abc/cpu.cfs_period_us", "100000");
+    tree.write("cpu,cpuacct/cpu.cfs_quota_us", "-1");
+    tree.write("cpu,cpuacct/cpu.cfs_period_us", "100000");
+    tree.write("memory/memory.limit_in_bytes", "9223372036854771712");
+    tree.proc("12:memory:/docker/abc\n4:cpu,cpuacct:/docker/abc\n1:name=systemd:/docker/abc\n");
+
+    ResourceLimits limits = tree.read();
+    EXPECT_EQ(limits.cgroup_version, 1);
+    EXPECT_DOUBLE_EQ(limits.cpu_quota, 1.5);
+    EXPECT_EQ(limits.memory_limit, 0u);
+}
+
+TEST(ResourceLimitsTest, NoCgroupMeansNoLimits) {
+    CgroupTree tree("secret_scanner_cgroup_none");
+    ResourceLimits limits = tree.read();
+    EXPECT_EQ(limits.cgroup_version, 0);
+    EXPECT_EQ(limits.cpu_quota, 0);
+    EXPECT_EQ(limits.memory_limit, 0u);
+    EXPECT_GE(limits.cpus(), 1u);
+}
+
+TEST(ResourceLimitsTest, WorkerCountRoundsTheQuotaDown) {
+    ResourceLimits limits;
+    limits.host_cpus = 64;
+    EXPECT_EQ(limits.cpus(), 64u);
+    limits.cpu_quota = 4.0;
+    EXPECT_EQ(limits.cpus(), 4u);
+    limits.cpu_quota = 2.9;
+    EXPECT_EQ(limits.cpus(), 2u);
+    limits.cpu_quota = 0.5;
+    EXPECT_EQ(limits.cpus(), 1u);
+    limits.cpu_quota = 8;
+    limits.affinity_cpus = 3;
+    EXPECT_EQ(limits.cpus(), 3u);
+}
+
+TEST(ResourceLimitsTest, ParsesByteSizes) {
+    uint64_t bytes = 0;
+    ASSERT_TRUE(parse_byte_size("1048576", bytes));
+    EXPECT_EQ(bytes, 1048576u);
+    ASSERT_TRUE(parse_byte_size("512M", bytes));
+    EXPECT_EQ(bytes, 512ull << 20);
+    ASSERT_TRUE(parse_byte_size("2GiB", bytes));
+    EXPECT_EQ(bytes, 2ull << 30);
+    ASSERT_TRUE(parse_byte_size("64kb", bytes));
+    EXPECT_EQ(bytes, 64ull << 10);
+    ASSERT_TRUE(parse_byte_size("0", bytes));
+    EXPECT_EQ(bytes, 0u);
+    EXPECT_FALSE(parse_byte_size("", bytes));
+    EXPECT_FALSE(parse_byte_size("M", bytes));
+    EXPECT_FALSE(parse_byte_size("-1G", bytes));
+    EXPECT_FALSE(parse_byte_size("12X", bytes));
+    EXPECT_FALSE(parse_byte_size("99999999999999T", bytes));
+}
+
+TEST(MemoryBudgetTest, BlocksUntilBuffersAreReleased) {
+    MemoryBudget budget(1000);
+    budget.acquire(600);
+
+    std::atomic<bool> acquired{false};
+    std::thread reader([&] {
+        budget.acquire(600);
+        acquired = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_FALSE(acquired.load());
+
+    budget.release(600);
+    reader.join();
+    EXPECT_TRUE(acquired.load());
+    EXPECT_EQ(budget.buffer_bytes(), 600u);
+    budget.release(600);
+    EXPECT_EQ(budget.in_use(), 0u);
+    EXPECT_EQ(budget.peak(), 600u);
+}
+
+TEST(MemoryBudgetTest, LetsOneOversizedBufferThroughAndChargesResults) {
+    MemoryBudget budget(1000);
+    // results beyond the budget leave room for one buffer at a time
+    budget.charge(1500);
+    budget.acquire(5000);
+    EXPECT_EQ(budget.in_use(), 6500u);
+
+    std::atomic<bool> acquired{false};
+    std::thread reader([&] {
+        budget.acquire(10);
+        acquired = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_FALSE(acquired.load());
+    budget.release(5000);
+    reader.join();
+    EXPECT_TRUE(acquired.load());
+
+    budget.release(10);
+    budget.discharge(1500);
+    EXPECT_EQ(budget.in_use(), 0u);
+    EXPECT_EQ(budget.peak(), 6500u);
+}
+
+TEST(MemoryBudgetTest, UnlimitedBudgetNeverBlocks) {
+    MemoryBudget budget;
+    budget.acquire(1ull << 40);
+    budget.acquire(1ull << 40);
+    EXPECT_EQ(budget.buffer_bytes(), 2ull << 40);
+    budget.release(1ull << 40);
+    budget.release(1ull << 40);
+    EXPECT_EQ(budget.in_use(), 0u);
+}
@@ -0,0 +1,72 @@
+#include <gtest/gtest.h>
+#include <fstream>
+#include <filesystem>
+#include <algorithm>
+#include <mutex>
+#include "walker.h"
+
+namespace fs = std::filesystem;
+
+class DirectoryWalkerTest : public ::testing::Test {
+protected:
+    fs::path root = fs::temp_directory_path() / "secret_scanner_walker_test";
+
+    void touch(const fs::path& rel) {
+        fs::create_directories((root / rel).parent_path());
+        std::ofstream ofs(root / rel);
+        ofs << "content\n";
+    }
+
+    void SetUp() override {
+        fs::remove_all(root);
+        touch("a.py");
+        touch("src/b.js");
+        touch("src/deep/nested/c.txt");
+        touch("node_modules/pkg/index.js");
+        touch("src/node_modules/pkg/index.js");
+        touch(".git/config");
+    }
+
+    void TearDown() override {
+        fs::remove_all(root);
+    }
+
+    std::vector<std::string> walk(size_t threads) {
+        std::vector<std::string> files;
+        std::mutex files_mutex;
+        DirectoryWalker walker({"node_modules", ".git"}, threads);
+        walker.walk(root.string(), [&](const std::string& path) {
+            std::lock_guard<std::mutex> lock(files_mutex);
+            files.push_back(fs::path(path).lexically_relative(root).generic_string());
+        });
+        std::sort(files.begin(), files.end());
+        return files;
+    }
+};
+
+TEST_F(DirectoryWalkerTest, FindsFilesAndPrunesIgnoredDirs) {
+    std::vector<std::string> expected = {"a.py", "src/b.js", "src/deep/nested/c.txt"};
+    EXPECT_EQ(walk(1), expected);
+}
+
+TEST_F(DirectoryWalkerTest, ParallelWalkMatchesSingleThreaded) {
+    for (int i = 0; i < 20; ++i) {
+        touch("many/dir" + std::to_string(i) + "/file.py");
+    }
+    EXPECT_EQ(walk(4), walk(1));
+    EXPECT_EQ(walk(4).size(), 23u);
+}
+
+TEST_F(DirectoryWalkerTest, ReportsUnreadableRoot) {
+    DirectoryWalker walker(PathFilter{});
+    size_t errors = walker.walk((root / "missing").string(), [](const std::string&) {});
+    EXPECT_EQ(errors, 1u);
+}
+
+TEST_F(DirectoryWalkerTest, FollowsFileLinksButNotDirectoryLinks) {
+    fs::create_symlink(root / "a.py", root / "link.py");
+    // a link back up the tree would loop forever if it were descended into
+    fs::create_directory_symlink(root / "src", root / "src/deep/loop");
+    std::vector<std::string> expected = {"a.py", "link.py", "src/b.js", "src/deep/nested/c.txt"};
+    EXPECT_EQ(walk(1), expected);
+}
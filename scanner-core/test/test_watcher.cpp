@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+#include <fstream>
+#include <filesystem>
+#include <algorithm>
+#include <thread>
+#include "watcher.h"
+
+namespace fs = std::filesystem;
+
+class DirectoryWatcherTest : public ::testing::Test {
+protected:
+    fs::path root = fs::temp_directory_path() / "secret_scanner_watcher_test";
+    PathFilter filter = PathFilter::from_ignored_dirs({"node_modules"});
+
+    void write(const fs::path& rel, const std::string& content = "content\n") {
+        fs::create_directories((root / rel).parent_path());
+        std::ofstream ofs(root / rel);
+        ofs << content;
+    }
+
+    std::string path(const fs::path& rel) const { return (root / rel).string(); }
+
+    static bool contains(const std::vector<std::string>& paths, const std::string& path) {
+        return std::find(paths.begin(), paths.end(), path) != paths.end();
+    }
+
+    bool next(DirectoryWatcher& watcher, WatchBatch& batch) {
+        return watcher.next_batch(batch, std::chrono::milliseconds(20), std::chrono::milliseconds(500));
+    }
+
+    void SetUp() override {
+#ifndef __linux__
+        GTEST_SKIP() << "watch mode needs inotify";
+#endif
+        fs::remove_all(root);
+        write("a.py");
+        write("src/b.js");
+        write("node_modules/pkg/index.js");
+    }
+
+    void TearDown() override {
+        fs::remove_all(root);
+    }
+};
+
+TEST_F(DirectoryWatcherTest, ReportsWritesAndRemovals) {
+    DirectoryWatcher watcher(filter);
+    std::string error;
+    ASSERT_TRUE(watcher.start(root.string(), error)) << error;
+    EXPECT_EQ(watcher.watch_count(), 2u);  // root and src, not node_modules
+
+    write("src/b.js", "changed\n");
+    write("node_modules/pkg/index.js", "ignored\n");
+    WatchBatch batch;
+    ASSERT_TRUE(next(watcher, batch));
+    EXPECT_EQ(batch.changed, std::vector<std::string>{path("src/b.js")});
+    EXPECT_TRUE(batch.removed.empty());
+
+    fs::remove(root / "a.py");
+    ASSERT_TRUE(next(watcher, batch));
+    EXPECT_EQ(batch.removed, std::vector<std::string>{path("a.py")});
+}
+
+TEST_F(DirectoryWatcherTest, CoalescesBurstsAndWatchesNewDirectories) {
+    DirectoryWatcher watcher(filter);
+    std::string error;
+    ASSERT_TRUE(watcher.start(root.string(), error)) << error;
+
+    for (int i = 0; i < 5; ++i) write("a.py", "v" + std::to_string(i) + "\n");
+    write("lib/deep/c.py");
+    WatchBatch batch;
+    ASSERT_TRUE(next(watcher, batch));
+    EXPECT_EQ(std::count(batch.changed.begin(), batch.changed.end(), path("a.py")), 1);
+    EXPECT_TRUE(contains(batch.changed, path("lib/deep/c.py")));
+
+    // the new directory is watched from now on
+    write("lib/deep/d.py");
+    ASSERT_TRUE(next(watcher, batch));
+    EXPECT_EQ(batch.changed, std::vector<std::string>{path("lib/deep/d.py")});
+
+    fs::remove_all(root / "lib");
+    ASSERT_TRUE(next(watcher, batch));
+    EXPECT_TRUE(contains(batch.removed, path("lib")));
+}
+
+TEST_F(DirectoryWatcherTest, StopWakesBlockedWatcher) {
+    DirectoryWatcher watcher(filter);
+    std::string error;
+    ASSERT_TRUE(watcher.start(root.string(), error)) << error;
+    std::thread stopper([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        watcher.stop();
+    });
+    WatchBatch batch;
+    EXPECT_FALSE(next(watcher, batch));
+    stopper.join();
+}